@@ -5,6 +5,7 @@
 #include "flux/vector.h"
 
 #include "camera.h"
+#include "kernels.h"
 
 // camera.cpp
 // (c) 2025 Connor J. Link. All Rights Reserved.
@@ -87,6 +88,9 @@ namespace luma
 		recompute_projection();
 		recompute_view();
 		recompute_rays();
+
+		previous_projection = projection;
+		previous_view = view;
 	}
 
 	bool Camera::update(float ts, olc::PixelGameEngine* pge_ptr) noexcept
@@ -97,6 +101,9 @@ namespace luma
 
 		moved = false;
 
+		previous_projection = projection;
+		previous_view = view;
+
 		const fx::vec3 up{ 0.f, 1.f, 0.f };
 		const auto forward = fx::normalize(fx::vec3{ -dir[0], 0.f, dir[2] });
 		right = fx::cross(forward, up);
@@ -131,6 +138,79 @@ namespace luma
 		/*const float Δpitch = -Δmouse.y * rotation_speed,
 					    Δyaw   = +Δmouse.x * rotation_speed;*/
 
+		recompute_direction();
+
+
+		//cjl::quat q = cjl::normalize(cjl::cross(cjl::angleAxis(-pitchDelta, right),
+		//	cjl::angleAxis(-yawDelta, cjl::vec3{ 0, 1, 0 })));
+		//dir = cjl::rotate(q, dir);
+		
+
+		if (moved)
+		{
+			recompute_view();
+			recompute_rays();
+		}
+
+		return moved;
+	}
+
+	void Camera::place(const fx::vec3& position, float new_yaw, float new_pitch, float new_fov) noexcept
+	{
+		pos = position;
+		yaw = new_yaw;
+		pitch = new_pitch;
+		fov = new_fov;
+
+		recompute_direction();
+		recompute_projection();
+		recompute_view();
+		recompute_rays();
+
+		// placement happens before the first frame, so there is no earlier view to reproject from
+		previous_projection = projection;
+		previous_view = view;
+	}
+
+	fx::vec2 Camera::reproject(const fx::vec3& world) const noexcept
+	{
+		const auto eye = fx::apply(previous_view, fx::extend(world, 1.f));
+		const auto clip = fx::apply(previous_projection, eye);
+
+		const auto scalar = 1 / clip[3];
+
+		// inverse of the mapping in recompute_rays()
+		return
+		{
+			(clip[0] * scalar + 1.f) * .5f * static_cast<float>(width),
+			(clip[1] * scalar + 1.f) * .5f * static_cast<float>(height),
+		};
+	}
+
+	bool Camera::project(const fx::vec3& world, fx::vec2& pixel) const noexcept
+	{
+		const auto eye = fx::apply(view, fx::extend(world, 1.f));
+		const auto clip = fx::apply(projection, eye);
+
+		if (clip[3] <= 0.f)
+		{
+			return false;
+		}
+
+		const auto scalar = 1 / clip[3];
+
+		// inverse of the mapping in recompute_rays()
+		pixel =
+		{
+			(clip[0] * scalar + 1.f) * .5f * static_cast<float>(width),
+			(clip[1] * scalar + 1.f) * .5f * static_cast<float>(height),
+		};
+
+		return true;
+	}
+
+	void Camera::recompute_direction(void) noexcept
+	{
 		// prevent gimbal lock by limiting pitch control
 		pitch = std::clamp(pitch, -fx::pi() / 4, fx::pi() / 4);
 
@@ -150,20 +230,6 @@ namespace luma
 			-(base[0] * sin_pitch * sin_yaw + base[1] * cos_pitch - base[2] * sin_pitch * cos_yaw),
 			 (base[0] * cos_pitch * sin_yaw + base[1] * sin_pitch + base[2] * cos_pitch * cos_yaw),
 		};
-
-
-		//cjl::quat q = cjl::normalize(cjl::cross(cjl::angleAxis(-pitchDelta, right),
-		//	cjl::angleAxis(-yawDelta, cjl::vec3{ 0, 1, 0 })));
-		//dir = cjl::rotate(q, dir);
-		
-
-		if (moved)
-		{
-			recompute_view();
-			recompute_rays();
-		}
-
-		return moved;
 	}
 
 	void Camera::recompute_projection(void) noexcept
@@ -182,36 +248,27 @@ namespace luma
 		view_inverse = ::inverse(view);
 	}
 
-	void Camera::recompute_rays(void) noexcept
+	RayBasis Camera::ray_basis(void) const noexcept
 	{
-		rays.resize(width * height);
-
-		for (auto y = 0u; y < height; y++)
+		// both transforms are linear, so each is applied once to the basis vectors and every ray is
+		// a weighted sum of the results, which the kernel forms eight pixels at a time
+		return
 		{
-			for (auto x = 0u; x < width; x++)
+			fx::apply(projection_inverse, fx::vec4{ 1.f, 0.f, 0.f, 0.f }),
+			fx::apply(projection_inverse, fx::vec4{ 0.f, 1.f, 0.f, 0.f }),
+			fx::apply(projection_inverse, fx::vec4{ 0.f, 0.f, 1.f, 1.f }),
 			{
-				const auto one = fx::broadcast<2>(1.f);
-
-				fx::vec2 coordinate = { static_cast<float>(x) / width,
-										static_cast<float>(y) / height };
-
-				// renormalization
-				coordinate = fx::scale(coordinate, 2.f);
-				coordinate = fx::subtract(coordinate, one);
-
-				const auto extended = fx::vec4{ coordinate[0], coordinate[1], 1.f, 1.f };
-				const auto target = fx::apply(projection_inverse, extended);
-
-				const auto truncated = fx::truncate(target);
-				const auto scalar = 1 / target[3];
+				fx::truncate(fx::apply(view_inverse, fx::vec4{ 1.f, 0.f, 0.f, 0.f })),
+				fx::truncate(fx::apply(view_inverse, fx::vec4{ 0.f, 1.f, 0.f, 0.f })),
+				fx::truncate(fx::apply(view_inverse, fx::vec4{ 0.f, 0.f, 1.f, 0.f })),
+			},
+		};
+	}
 
-				const auto corrected = fx::scale(truncated, scalar);
-				const auto normalized = fx::normalize(corrected);
-				const auto padded = fx::extend(normalized, 0.f);
+	void Camera::recompute_rays(void) noexcept
+	{
+		rays.resize(width * height);
 
-				const auto ray = fx::apply(view_inverse, padded);
-				rays[y * width + x] = fx::truncate(ray);
-			}
-		}
+		kernels().generate_rays(ray_basis(), width, height, rays.data());
 	}
 }
\ No newline at end of file
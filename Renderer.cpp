@@ -3,11 +3,14 @@ import std;
 #include "olcPixelGameEngine.h"
 
 #include "flux/timer.h"
-#include "flux/random.h"
 #include "flux/vector.h"
 
 #include "renderer.h"
+#include "post.h"
 #include "arguments.h"
+#include "description.h"
+#include "log.h"
+#include "color.h"
 
 // renderer.cpp
 // (c) 2025 Connor J. Link. All Rights Reserved.
@@ -54,21 +57,6 @@ namespace
 		return out;
 	}
 
-	fx::vec3 tonemap(const fx::vec3& color)
-	{
-		auto func = [&](float in)
-		{
-			return 1 - std::exp(-in);
-		};
-
-		return
-		{
-			func(color[0]),
-			func(color[1]),
-			func(color[2]),
-		};
-	}
-
 	fx::vec3 lerp(const fx::vec3& color1, const fx::vec3& color2, fx::platform_type t)
 	{
 		const auto t1 = 1 - t;
@@ -111,25 +99,146 @@ namespace
 
 namespace
 {
-	static constexpr auto OFFSET = .001f;
+	// depth feature written for sky pixels so they never blend with geometry
+	static constexpr auto SKY_DEPTH = 1e4f;
+
+	fx::platform_type blur_radius(float focus) noexcept
+	{
+		const auto focused_blur = .5f;
+		const auto defocused_blur = 5.f;
+
+		return static_cast<fx::platform_type>(std::lerp(focused_blur, defocused_blur, focus));
+	}
+
+	enum class MaterialChange
+	{
+		NONE,
+		// only diffuse colours differ, which scenes lit only at the first hit can rescale to
+		DIFFUSE,
+		// shading differs, so the accumulation restarts but the cached visibility stays
+		SHADING,
+		// emission changed as well, so the light tree has to be rebuilt
+		EMISSION,
+	};
+
+	MaterialChange compare(const std::vector<luma::Material>& before, const std::vector<luma::Material>& after) noexcept
+	{
+		if (before.size() != after.size())
+		{
+			return MaterialChange::EMISSION;
+		}
+
+		auto change = MaterialChange::NONE;
+
+		for (auto i = 0u; i < before.size(); i++)
+		{
+			const auto& lhs = before[i];
+			const auto& rhs = after[i];
+
+			if (lhs.emission[0] != rhs.emission[0] || lhs.emission[1] != rhs.emission[1] || lhs.emission[2] != rhs.emission[2])
+			{
+				return MaterialChange::EMISSION;
+			}
+
+			if (lhs.albedo != rhs.albedo || lhs.metallic != rhs.metallic || lhs.roughness != rhs.roughness)
+			{
+				change = MaterialChange::SHADING;
+			}
+
+			else if (change == MaterialChange::NONE && (lhs.diffuse[0] != rhs.diffuse[0] || lhs.diffuse[1] != rhs.diffuse[1] || lhs.diffuse[2] != rhs.diffuse[2]))
+			{
+				change = MaterialChange::DIFFUSE;
+			}
+		}
 
-	fx::vec3 noise(const fx::vec3& dir, fx::platform_type offset = OFFSET)
+		return change;
+	}
+
+	// index of the only entry that differs, or none when several do
+	std::uint32_t edited_material(const std::vector<luma::Material>& before, const std::vector<luma::Material>& after) noexcept
+	{
+		auto edited = luma::Renderer::NO_MATERIAL;
+
+		for (auto i = 0u; i < std::min(before.size(), after.size()); i++)
+		{
+			const auto& lhs = before[i];
+			const auto& rhs = after[i];
+
+			if (lhs.diffuse[0] != rhs.diffuse[0] || lhs.diffuse[1] != rhs.diffuse[1] || lhs.diffuse[2] != rhs.diffuse[2]
+			 || lhs.albedo != rhs.albedo || lhs.metallic != rhs.metallic || lhs.roughness != rhs.roughness
+			 || lhs.emission[0] != rhs.emission[0] || lhs.emission[1] != rhs.emission[1] || lhs.emission[2] != rhs.emission[2])
+			{
+				if (edited != luma::Renderer::NO_MATERIAL)
+				{
+					return luma::Renderer::NO_MATERIAL;
+				}
+
+				edited = i;
+			}
+		}
+
+		return edited;
+	}
+
+	// without indirect light or reflections a material is only ever shaded at the first hit, where its
+	// diffuse colour scales the whole direct term
+	bool first_hit_only(const std::vector<luma::Material>& materials) noexcept
+	{
+		return std::ranges::all_of(materials, [](const luma::Material& material) { return material.albedo == 0.f && material.metallic == 0.f; });
+	}
+
+	// maps a sample in [0, 1)^3 to an offset in [-offset, offset]^3
+	fx::vec3 jitter(const fx::vec3& sample, fx::platform_type offset) noexcept
+	{
+		return fx::scale(fx::subtract(fx::scale(sample, 2.f), fx::broadcast<3>(1.f)), offset);
+	}
+
+	fx::vec3 noise(const fx::vec3& dir, const fx::vec3& sample, fx::platform_type offset)
 	{
-		const auto noise = fx::Random::vec3(-offset, offset);
+		const auto noise = ::jitter(sample, offset);
 		const auto dir_noised = fx::add(dir, noise);
 
 		return dir_noised;
 	};
 
+	// share of indirect paths drawn from the guide once it is trained; the rest keep cosine sampling so
+	// that directions the guide has not learned about are still reached
+	static constexpr auto GUIDE_FRACTION = .5f;
+
+	// paths traced for each new irradiance cache record
+	static constexpr auto RECORD_PATHS = 64u;
+
+	constexpr auto PHOTONS_PER_PASS = 1u << 16;
+
+	// a photon's decisions reuse the dimensions of the camera path's bounce blocks
+	constexpr auto PHOTON_SOURCE = luma::Sampler::LIGHT_PICK;
+	constexpr auto PHOTON_EMISSION = luma::Sampler::LIGHT_POINT;
+
+	// float hits nearer than this share of the sphere's radius are resolved again in double: the
+	// quadratic's constant term is rounded relative to the radius squared, so the shorter the distance
+	// the larger its relative error, and short hits are the ones in corners and contact regions
+	constexpr auto CLOSE_HIT = .25f;
+
+	// occlusion rays of the preview mode only look this far, so open space around a point ends their traversal early
+	constexpr auto OCCLUSION_DISTANCE = 1.f;
+	// share of the preview's lighting that does not depend on the directional light
+	constexpr auto AMBIENT = .3f;
+
+	// photon mapping renders everything else exactly as the path tracer does
+	bool traces_paths(luma::RenderMode mode) noexcept
+	{
+		return mode == luma::RenderMode::PATHTRACE || mode == luma::RenderMode::PHOTONMAP;
+	}
+
 	fx::platform_type fresnel(const luma::Intersection& intersection, const fx::vec3& dir)
 	{
 		auto ray = fx::invert(dir);
 
 		auto metallic = 1.f;
 
-		if (intersection.object != nullptr)
+		if (intersection.material != nullptr)
 		{
-			metallic = intersection.object->material.metallic;
+			metallic = intersection.material->metallic;
 		}
 
 		// fresnel's law
@@ -167,303 +276,1231 @@ namespace luma
 
 		delete[] accumulated_data;
 		accumulated_data = new fx::vec3[size]();
-	}
 
-	Intersection Renderer::miss(void) noexcept
-	{
-		return { fx::vec3(.6f, .7f, .95f), 1.f, 1.f, {}, nullptr };
-	}
+		features.reset(size);
 
-	fx::vec3 Renderer::direct_illumination(const Intersection& intersection) noexcept
-	{
-		return fx::vec3();
-	}
+		frame_color.resize(size);
+		frame_features.reset(size);
 
-	fx::vec3 Renderer::indirect_illumination(const Intersection& intersection) noexcept
-	{
-		fx::vec3 out{};
+		gbuffer.resize(size);
 
-		// TODO: dynamically dispatch a different render function so as to not waste a comparison every pixel
-		if (_options.mode != RenderMode::PATHTRACE)
+		if (_options.lights == LightSampling::RESTIR)
 		{
-			return out;
+			restir.resize(_options.width, _options.height);
 		}
 
-		for (auto sample = 0u; sample < _options.paths; sample++)
+		if (!_options.environment.empty())
 		{
-			auto dir = fx::Random::vec3_sphere();
+			environment.load(_options.environment);
+		}
 
-			// ensure the noise points outward
-			if (fx::dot(dir, intersection.normal) < 0)
+		if (!_options.particles.empty())
+		{
+			if (scene.open_particles(_options.particles, _options.validation == Validation::FULL))
 			{
-				dir = fx::invert(dir);
+				log(std::format("mapped {} spheres from `{}`", scene.size(), _options.particles));
 			}
+		}
+
+		else if (!_description.spheres.empty())
+		{
+			scene.assign(_description.materials, _description.spheres, _description.material_ids);
+		}
+
+		if (_options.sampling == Sampling::BLUE_NOISE)
+		{
+			Sampler::prepare();
+		}
 
-			const auto new_dir = fx::add(intersection.normal, dir);
-			const auto ray = Ray{ intersection.pos, new_dir };
-			const auto cast = trace_ray(ray);
+		if (scene.empty())
+		{
+			scene.materials = materials;
 
-			if (cast.object != nullptr)
+			for (const auto& sphere : spheres)
 			{
-				out = fx::add(out, cast.object->material.diffuse);
+				scene.add(sphere);
 			}
 		}
 
-		const auto divisor = 1.f / _options.samples;
-		out = fx::scale(out, divisor);
+		if (_description.light)
+		{
+			light = *_description.light;
+		}
 
-		return out;
-	}
+		if (_description.camera_pos || _description.camera_yaw || _description.camera_pitch || _description.camera_fov)
+		{
+			camera.place(_description.camera_pos.value_or(camera.pos), _description.camera_yaw.value_or(camera.yaw),
+				_description.camera_pitch.value_or(camera.pitch), _description.camera_fov.value_or(camera.fov));
+		}
 
-	Ray Renderer::reflect_intersection(const Intersection& intersection, const Ray& ray) noexcept
-	{
-		// need to ensure that the reflection ray doesn't re-hit the same object due to being inside (floating point inaccuracy)
-		const auto extruded = fx::scale(intersection.normal, .001f);
-		const auto pos = fx::add(intersection.pos, extruded);
+		acceleration = _options.acceleration;
 
-		// roughness controls the random dispersion of reflection rays
-		const auto gain = .2f * intersection.object->material.roughness;
-		const auto roughness_noise = fx::Random::vec3(-gain, gain);
-		const auto normal = fx::add(intersection.normal, roughness_noise);
+		// a particle file's own tree is used in place, where a grid would have to read every sphere to build
+		if (acceleration == Acceleration::AUTO)
+		{
+			acceleration = !scene.prebuilt().empty() || !Grid::suitable(scene.spheres()) ? Acceleration::BVH : Acceleration::GRID;
+		}
 
-		const auto dir = fx::reflect(ray.dir, normal);
+		const auto exporting = !_options.export_path.empty();
 
-		return Ray{ pos, dir };
-	}
+		// the bvh is needed either for tracing or for embedding in an exported particle file
+		if (acceleration == Acceleration::BVH || exporting)
+		{
+			if (!scene.prebuilt().empty())
+			{
+				bvh.adopt(scene.prebuilt(), scene.spheres());
+			}
 
-	Intersection Renderer::trace_ray(const Ray& ray) noexcept
-	{
-		static constexpr auto max = std::numeric_limits<float>::max();
+			else
+			{
+				const auto order = bvh.build(scene.spheres());
+				scene.reorder(order);
+				bvh.attach(scene.spheres());
+			}
+
+			log(std::format("using 8-wide bvh with {} nodes over {} spheres", bvh.node_count(), scene.size()));
+		}
 
-		auto distance = max;
+		shaded_materials = scene.materials;
 
-		Intersection intersection{};
+		if (exporting && scene.save_particles(_options.export_path, bvh.nodes()))
+		{
+			log(std::format("exported {} spheres to `{}`", scene.size(), _options.export_path));
+		}
 
-		for (auto& sphere : spheres)
+		if (acceleration == Acceleration::GRID)
 		{
-			const auto diff = fx::subtract(ray.pos, sphere.pos);
+			grid.build(scene.spheres());
+			log(std::format("built uniform grid with {} cells over {} spheres", grid.cell_count(), scene.size()));
+		}
+
+		light_tree.build(scene);
 
-			const auto a = fx::dot(ray.dir, ray.dir);
-			const auto b = 2 * fx::dot(diff, ray.dir);
-			const auto c = fx::dot(diff, diff) - (sphere.radius * sphere.radius);
+		if (_options.irradiance == Irradiance::CACHE)
+		{
+			irradiance_cache.reset();
+		}
 
-			// descriminant
-			const auto d = (b * b) - (4 * a * c);
+		if (_options.guiding == Guiding::SDTREE)
+		{
+			fx::vec3 lo{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+			fx::vec3 hi{ std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
 
-			if (d > 0) [[unlikely]]
+			for (const auto& sphere : scene.spheres())
 			{
-				const auto t = (-b - std::sqrt(d)) / (2 * a);
-				const auto e = (-b + std::sqrt(d)) / (2 * a);
+				const fx::vec3 center{ sphere.x, sphere.y, sphere.z };
 
-				if (t > 0) [[likely]]
+				for (auto axis = 0; axis < 3; axis++)
 				{
-					const auto progress = fx::scale(ray.dir, t);
-					const auto hit = fx::add(ray.pos, progress);
+					lo[axis] = std::min(lo[axis], center[axis] - sphere.radius);
+					hi[axis] = std::max(hi[axis], center[axis] + sphere.radius);
+				}
+			}
+
+			guide.reset(lo, hi);
+		}
 
-					const auto toward = fx::subtract(hit, sphere.pos);
-					const auto normal = fx::normalize(toward);
+		if (!light_tree.empty())
+		{
+			log(std::format("built light tree over {} emissive spheres", light_tree.size()));
+		}
 
-					if (t < distance)
-					{
-						distance = t;
-						intersection = { hit, normal, t, e, &sphere };
-					}
-				}
+		if (_options.mode == RenderMode::PHOTONMAP)
+		{
+			photon_map.aim(scene, light_tree, light);
+			photons.resize(::PHOTONS_PER_PASS * std::max(_options.bounces, 2u) - ::PHOTONS_PER_PASS);
+
+			if (photon_map.empty())
+			{
+				warning("photon mapping enabled but no metallic sphere can cast a caustic");
 			}
 		}
 
-		//no object was hit
-		if (distance == max) [[likely]]
+		if (_options.mode == RenderMode::AMBIENT_OCCLUSION)
 		{
-			return miss();
+			build_shadow_map();
 		}
 
-#ifdef SIMPLE_SHADOWS
-		const auto scalar = std::clamp(fx::dot(light, intersection.normal), 0.f, 1.0f);
-		intersection.color = fx::scale(intersection.color, scalar);
-#endif
+		if (_options.mode == RenderMode::LIGHTTRACE)
+		{
+			splats.resize(size);
 
-		return intersection;
+			if (light_tree.empty())
+			{
+				warning("light tracing enabled but the scene has no emissive spheres to start paths from");
+			}
+		}
 	}
 
-	PixelResult Renderer::render_pixel(std::uint32_t x, std::uint32_t y, fx::platform_type blur) noexcept
+	fx::vec3 Renderer::miss(const fx::vec3& dir) const noexcept
 	{
-		fx::vec3 direct{}, indirect{}, result{};
+		if (!environment.empty())
+		{
+			return environment.lookup(dir);
+		}
 
-		auto dir = camera.rays[y * camera.width + x];
-		auto pos = camera.pos;
+		const fx::vec3 top_sky_color{ .529f, .808f, .922f };
+		const fx::vec3 bottom_sky_color{ .106f, .275f, .711f };
 
-		auto depth = std::numeric_limits<float>::max();
+		const auto clamped = std::clamp(dir[1], -1.f, 1.f);
+		const auto adjusted = (clamped + 1.f) * .5f;
 
-		Intersection intersection{};
+		return ::lerp(top_sky_color, bottom_sky_color, adjusted);
+	}
 
-		for (auto bounce = 0u; bounce < _options.bounces; bounce++)
+	fx::vec3 Renderer::direct_illumination(const Intersection& intersection, const Sampler& sampler, std::uint32_t dimension, std::uint32_t pixel) noexcept
+	{
+		auto out = fx::vec3();
+
+		if (!light_tree.empty())
 		{
-			const auto dir_noised = noise(dir, blur);
-			const auto ray = Ray{ camera.pos, dir_noised };
-			intersection = trace_ray(ray);
+			out = fx::add(out, emitter_illumination(intersection, sampler, dimension, pixel));
+		}
 
-			if (intersection.object == nullptr)
-			{
-				const fx::vec3 top_sky_color{ .529f, .808f, .922f };
-				const fx::vec3 bottom_sky_color{ .106f, .275f, .711f };
+		if (!environment.empty())
+		{
+			out = fx::add(out, environment_illumination(intersection, sampler, dimension));
+		}
 
-				const auto clamped = std::clamp(dir_noised[1], -1.f, 1.f);
-				const auto adjusted = (clamped + 1.f) * .5f;
+		return out;
+	}
 
-				const auto sky = ::lerp(top_sky_color, bottom_sky_color, adjusted);
+	fx::vec3 Renderer::environment_illumination(const Intersection& intersection, const Sampler& sampler, std::uint32_t dimension) noexcept
+	{
+		auto radiance = fx::vec3();
+		auto pdf = 0.f;
 
-				direct = fx::add(direct, sky);
+		// bright regions such as the sun are found directly through the map's sampling tables
+		const auto dir = environment.sample(sampler.get2d(dimension + Sampler::ENVIRONMENT), radiance, pdf);
+		const auto cos_theta = fx::dot(intersection.normal, dir);
 
-				break;
-			}
+		if (pdf <= 0.f || cos_theta <= 0.f)
+		{
+			return fx::vec3();
+		}
 
-			if (bounce == 0)
-			{
-				depth = intersection.distance;
-			}
+		const auto shadow = Ray{ offset_origin(intersection.pos, intersection.normal), dir };
 
-			const auto object = intersection.object;
-			const auto& material = object->material;
-			
-			const auto diffuse = material.diffuse;
+		if (any_hit(shadow))
+		{
+			return fx::vec3();
+		}
 
-			const auto inverted = fx::invert(dir_noised);
-			const auto cos_theta = fx::dot(inverted, intersection.normal);
+		const auto weight = cos_theta / (fx::pi() * pdf);
+		return fx::scale(fx::multiply(intersection.material->diffuse, radiance), weight);
+	}
 
-			if (cos_theta >= 0)
+	fx::vec3 Renderer::emitter_illumination(const Intersection& intersection, const Sampler& sampler, std::uint32_t dimension, std::uint32_t pixel) noexcept
+	{
+		const auto origin = offset_origin(intersection.pos, intersection.normal);
+
+		if (pixel != NO_PIXEL)
+		{
+			const ShadingPoint point{ intersection.pos, intersection.normal, intersection.material->diffuse, intersection.distance };
+
+			auto reservoir = restir.resample(point, camera, light_tree, sampler);
+			fx::vec3 out{};
+
+			if (reservoir.weight > 0.f)
 			{
-				auto indirect = fx::broadcast<3>(0.f);
-				if (material.albedo > 0)
+				const auto to = fx::subtract(reservoir.sample.pos, origin);
+				const auto distance = std::sqrt(fx::dot(to, to));
+				const auto shadow = Ray{ origin, fx::scale(to, 1.f / distance) };
+
+				if (closest_hit(shadow, distance * 1.001f + .001f).primitive == light_tree.emitter(reservoir.sample.emitter).primitive)
 				{
-					indirect = indirect_illumination(intersection);
-					indirect = fx::scale(indirect, material.albedo);
+					out = fx::scale(Restir::unshadowed(point, reservoir.sample, light_tree), reservoir.weight);
 				}
 
-				const auto value = ((cos_theta + 1.f) * .5f);
+				else
+				{
+					reservoir.weight = 0.f;
+				}
+			}
 
-				const auto scalar = value * (1 - material.metallic);
-				const auto capture = lerp(diffuse, indirect, 1 - scalar);
-				const auto scaled = fx::scale(capture, scalar * .8f);
+			restir.store(pixel, reservoir, point);
+			return out;
+		}
 
-				direct = fx::add(direct, scaled);
-			}
+		LightSample sample{};
 
+		if (!light_tree.sample(intersection.pos, intersection.normal, sampler.get1d(dimension + Sampler::LIGHT_PICK), sampler.get2d(dimension + Sampler::LIGHT_POINT), sample))
+		{
+			return fx::vec3();
+		}
 
-			if (material.metallic == 0)
-			{
-				// non-reflective surfaces
-				break;
-			}
+		const auto cos_theta = fx::dot(intersection.normal, sample.dir);
+
+		if (cos_theta <= 0.f)
+		{
+			return fx::vec3();
+		}
+
+		// one shadow ray; the light is visible if nothing else is hit before it
+		const auto shadow = Ray{ origin, sample.dir };
 
-			dir = reflect_intersection(intersection, ray).dir;
+		if (closest_hit(shadow, sample.distance * 1.001f + .001f).primitive != sample.primitive)
+		{
+			return fx::vec3();
 		}
 
-		result = ::tonemap(direct);
-		return { result, depth };
+		// lambertian brdf over the density the light was sampled with
+		const auto weight = cos_theta / (fx::pi() * sample.pdf);
+		return fx::scale(fx::multiply(intersection.material->diffuse, sample.radiance), weight);
 	}
 
-	void Renderer::render_to(std::uint32_t* target, olc::PixelGameEngine* pge) noexcept
+	fx::vec3 Renderer::indirect_illumination(const Intersection& intersection, const Sampler& sampler, std::uint32_t dimension, bool primary) noexcept
 	{
-		pge->Clear(olc::BLACK);
+		fx::vec3 out{};
 
-		fx::Timer timer{};
+		// TODO: dynamically dispatch a different render function so as to not waste a comparison every pixel
+		if (!::traces_paths(_options.mode))
+		{
+			return out;
+		}
 
-		const auto width = _options.width;
-		const auto height = _options.height;
+		// records hold the mean over their paths, rescaled to match the uncached sum over paths / samples
+		const auto scale = static_cast<float>(_options.paths) / _options.samples;
+		const auto cached = primary && _options.irradiance == Irradiance::CACHE;
 
-		camera.update(frametime, pge);
+		if (cached && irradiance_cache.lookup(intersection.pos, intersection.normal, out))
+		{
+			return fx::scale(out, scale);
+		}
 
-		if (camera.moved)
+		// a new record is shared by every pixel around it, so it is worth many more paths than one pixel
+		const auto paths = cached ? std::max(_options.paths, ::RECORD_PATHS) : _options.paths;
+		auto inverse_distance = 0.f;
+
+		const auto guided = _options.guiding == Guiding::SDTREE;
+		const auto leaf = guided ? guide.leaf(intersection.pos) : 0u;
+		const auto guide_fraction = guided && guide.ready() ? ::GUIDE_FRACTION : 0.f;
+
+		for (auto sample = 0u; sample < paths; sample++)
 		{
-			frame_count = 1.f;
+			const auto stream = sampler.split(sample, paths);
+			const auto uv = stream.get2d(dimension + Sampler::HEMISPHERE);
 
-			delete[] accumulated_data;
-			accumulated_data = new fx::vec3[width * height]();
+			fx::vec3 dir{};
 
-			for (auto i = 0u; i < width * height; i++)
+			if (guide_fraction > 0.f && stream.get1d(dimension + Sampler::GUIDE) < guide_fraction)
 			{
-				accumulated_data[i] = fx::broadcast<3>(0.f);
+				dir = guide.sample(leaf, uv);
 			}
 
-			camera.moved = false;
-		}
-
-	//#pragma omp parallel for
-		for (auto y = 0u; y < height; ++y)
-		{
-			for (auto x = 0u; x < width; ++x)
+			else
 			{
-//#define TESTING
-#ifndef TESTING
-				auto index = (y * width) + x;
+				// the normal plus a point on the unit sphere is distributed by the cosine
+				dir = fx::normalize(fx::add(intersection.normal, uniform_sphere(uv)));
+			}
 
-				fx::vec3 result{};
+			const auto cos_theta = fx::dot(intersection.normal, dir);
 
-				// TODO: reincorporate pixel sampling
-				//for (auto i = 0; i < _options.samples; i++)
-				//{
-				// result = fx::add(result, iteration.output);
-				//}
-				// const auto divisor = fx::native(1) / _options.samples;
-				// result = fx::scale(result, divisor);
+			if (cos_theta <= 0.f)
+			{
+				continue;
+			}
 
-				//const auto initial_sample = render_pixel(x, y);
+			// one-sample mis over the mixture; without guiding the weight is exactly one
+			const auto cosine_pdf = cos_theta / fx::pi();
+			auto pdf = cosine_pdf;
 
-				auto dir = camera.rays[y * camera.width + x];
-				auto pos = camera.pos;
+			if (guide_fraction > 0.f)
+			{
+				pdf = guide_fraction * guide.pdf(leaf, dir) + (1.f - guide_fraction) * cosine_pdf;
+			}
 
-				const auto ray = Ray{ pos, dir };
+			const auto ray = Ray{ offset_origin(intersection.pos, intersection.normal), dir };
+			const auto cast = closest_hit(ray);
 
-				const auto intersection = trace_ray(ray);
-				auto depth = std::numeric_limits<float>::max();
-				if (intersection.object != nullptr)
-				{
-					depth = intersection.distance;
-				}
+			// only the material is needed, so skip resolving the full intersection
+			fx::vec3 radiance{};
 
-				const auto depth_difference = depth - camera.depth;
+			if (cast.primitive != Hit::NONE)
+			{
+				radiance = scene.material(cast.primitive).diffuse;
+				inverse_distance += 1.f / std::max(cast.distance, IrradianceCache::MIN_RADIUS);
+			}
 
-				auto focus = 1.f - std::exp(-std::pow(depth_difference, 10));
+			out = fx::add(out, fx::scale(radiance, cosine_pdf / pdf));
 
-				const auto focused_blur = .5f;
-				const auto defocused_blur = 5.f;
+			if (guided && guide.training())
+			{
+				guide.record(leaf, dir, luminance(radiance) / pdf);
+			}
+		}
 
-				const auto blur = std::lerp(focused_blur, defocused_blur, focus);
+		out = fx::scale(out, 1.f / paths);
 
-				const auto real_sample = render_pixel(x, y, static_cast<fx::platform_type>(blur));
-				result = real_sample.output;
+		if (cached)
+		{
+			// harmonic mean distance; rays that escape put no nearby geometry in the way
+			const auto radius = inverse_distance > 0.f ? paths / inverse_distance : IrradianceCache::MAX_RADIUS;
+			irradiance_cache.insert(intersection.pos, intersection.normal, out, radius);
+		}
 
-				const auto red = static_cast<std::uint8_t>(255.f * result[0]);
-				const auto green = static_cast<std::uint8_t>(255.f * result[1]);
-				const auto blue = static_cast<std::uint8_t>(255.f * result[2]);
-				const auto alpha = static_cast<std::uint8_t>(255.f * focus);
-				//const auto alpha = static_cast<std::uint8_t>(255.0f);
+		return fx::scale(out, scale);
+	}
 
-				olc::Pixel p = olc::Pixel{ red, green, blue, alpha };
+	void Renderer::trace_photons(void) noexcept
+	{
+		const auto pass = photon_map.pass();
+		const auto share = 1.f / ::PHOTONS_PER_PASS;
 
-				pge->DrawCircle(x, y, (int32_t)blur, p);
+		std::fill(std::execution::par, photons.begin(), photons.end(), Photon{});
 
-				
-				if (camera.show_depth)
-				{
-					if (focus < .5f)
-					{
-						result = fx::scale(result, 1.2f);
-					}
-				}
-				
-				
-				auto& data = accumulated_data[index];
-				data = fx::add(data, result);
+		std::vector<std::uint32_t> indices(::PHOTONS_PER_PASS);
+		std::iota(indices.begin(), indices.end(), 0u);
 
-				const auto mean = fx::scale(accumulated_data[index], 1 / frame_count);
-				target[index] = RGB(mean);
+		// a photon lands at most once per bounce after the first, so bounce b fills block b - 1 of the slots
+		std::for_each(std::execution::par, indices.begin(), indices.end(), [&](std::uint32_t index)
+		{
+			// every photon follows its own scrambled sequence, one sample further along each pass
+			const Sampler sampler{ Sampling::SOBOL, index & 0xFFFFu, index >> 16, pass };
+
+			Ray ray{};
+			fx::vec3 power{};
+
+			if (!photon_map.emit(sampler.get1d(::PHOTON_SOURCE), sampler.get2d(::PHOTON_EMISSION), ray, power))
+			{
+				return;
+			}
+
+			for (auto bounce = 0u; bounce < _options.bounces; bounce++)
+			{
+				const auto intersection = trace_ray(ray);
+
+				if (intersection.material == nullptr)
+				{
+					return;
+				}
+
+				// the first hit is direct light, which the camera paths already sample; anything after a metal is a caustic
+				if (bounce > 0)
+				{
+					photons[(bounce - 1) * ::PHOTONS_PER_PASS + index] = { intersection.pos, intersection.normal, fx::scale(power, share) };
+				}
+
+				// camera paths stop at non-metals, so photons landing there are the only ones they can gather
+				if (intersection.material->metallic == 0)
+				{
+					return;
+				}
+
+				ray = reflect_intersection(intersection, ray, sampler, bounce * Sampler::DIMENSIONS_PER_BOUNCE);
+			}
+		});
+
+		photon_map.build(photons);
+	}
+
+	void Renderer::trace_light_paths(void) noexcept
+	{
+		const auto width = camera.width;
+		const auto height = camera.height;
+		const auto frame = static_cast<std::uint32_t>(frame_count) - 1;
+
+		std::fill(std::execution::par, splats.begin(), splats.end(), fx::broadcast<3>(0.f));
+
+		// solid angle of the center pixel on an image plane one unit in front of the camera, from which every
+		// other pixel's follows by the cube of the cosine to the view direction
+		const auto center = (height / 2) * width + width / 2;
+		const auto across = fx::subtract(camera.rays[center + 1], camera.rays[center]);
+		const auto down = fx::subtract(camera.rays[center + width], camera.rays[center]);
+		const auto extent = fx::cross(across, down);
+		const auto pixel_area = std::sqrt(fx::dot(extent, extent));
+
+		const auto share = 1.f / splats.size();
+
+		// importance of the pixel a point is seen through: one over its solid angle and the squared distance,
+		// so that splatting radiance times the point's cosine estimates the pixel's mean radiance
+		const auto connect = [&](const fx::vec3& pos, const fx::vec3& normal, fx::vec3& to_camera, std::uint32_t& pixel) -> float
+		{
+			fx::vec2 coordinate{};
+
+			if (!camera.project(pos, coordinate) || coordinate[0] < 0.f || coordinate[1] < 0.f || coordinate[0] >= width || coordinate[1] >= height)
+			{
+				return 0.f;
+			}
+
+			const auto offset = fx::subtract(camera.pos, pos);
+			const auto distance2 = fx::dot(offset, offset);
+			const auto distance = std::sqrt(distance2);
+
+			to_camera = fx::scale(offset, 1.f / distance);
+
+			const auto cos_camera = -fx::dot(to_camera, camera.dir);
+
+			if (cos_camera <= 0.f || fx::dot(normal, to_camera) <= 0.f)
+			{
+				return 0.f;
+			}
+
+			// the camera is not part of the scene, so nothing can be hit at the far end of this ray
+			if (any_hit(Ray{ offset_origin(pos, normal), to_camera }, distance))
+			{
+				return 0.f;
+			}
+
+			pixel = static_cast<std::uint32_t>(coordinate[1]) * width + static_cast<std::uint32_t>(coordinate[0]);
+			return 1.f / (pixel_area * cos_camera * cos_camera * cos_camera * distance2);
+		};
+
+		// many paths land in the same pixel at once, so each channel is added atomically rather than under a lock
+		const auto splat = [&](std::uint32_t pixel, const fx::vec3& value)
+		{
+			for (auto channel = 0; channel < 3; channel++)
+			{
+				std::atomic_ref<float>(splats[pixel][channel]).fetch_add(value[channel], std::memory_order_relaxed);
+			}
+		};
+
+		// one path per pixel, each following the sample sequence of the pixel it is numbered after
+		std::vector<std::uint32_t> pixels(splats.size());
+		std::iota(pixels.begin(), pixels.end(), 0u);
+
+		std::for_each(std::execution::par, pixels.begin(), pixels.end(), [&](std::uint32_t index)
+		{
+			const Sampler sampler{ _options.sampling, index % width, index / width, frame };
+
+			LightEmission emission{};
+
+			if (!light_tree.emit(sampler.get1d(Sampler::LIGHT_PICK), sampler.get2d(Sampler::LIGHT_POINT), sampler.get2d(Sampler::HEMISPHERE), emission))
+			{
+				return;
+			}
+
+			fx::vec3 to_camera{};
+			auto pixel = 0u;
+
+			// the emitter itself, as seen by the camera
+			if (const auto importance = connect(emission.pos, emission.normal, to_camera, pixel); importance > 0.f)
+			{
+				const auto cos_light = fx::dot(emission.normal, to_camera);
+				splat(pixel, fx::scale(emission.radiance, cos_light * importance * share / emission.pdf));
+			}
+
+			// flux carried by the path; the cosine of the emitted direction cancels against its density
+			auto power = fx::scale(emission.radiance, fx::pi() * share / emission.pdf);
+			auto ray = Ray{ offset_origin(emission.pos, emission.normal), emission.dir };
+
+			for (auto bounce = 0u; bounce < _options.bounces; bounce++)
+			{
+				const auto dimension = (bounce + 1) * Sampler::DIMENSIONS_PER_BOUNCE;
+				const auto intersection = trace_ray(ray);
+
+				if (intersection.material == nullptr)
+				{
+					return;
+				}
+
+				const auto& material = *intersection.material;
+
+				// metals only reflect their diffuse share, as in render_pixel
+				if (const auto importance = connect(intersection.pos, intersection.normal, to_camera, pixel); importance > 0.f && material.metallic < 1.f)
+				{
+					const auto cos_surface = fx::dot(intersection.normal, to_camera);
+					const auto brdf = fx::scale(material.diffuse, (1.f - material.metallic) / fx::pi());
+
+					splat(pixel, fx::scale(fx::multiply(power, brdf), cos_surface * importance));
+				}
+
+				// choosing between the mirror and diffuse lobes by metallic keeps the path's weight unchanged by the choice
+				if (sampler.get1d(dimension + Sampler::GUIDE) < material.metallic)
+				{
+					ray = reflect_intersection(intersection, ray, sampler, dimension);
+					continue;
+				}
+
+				power = fx::multiply(power, fx::scale(material.diffuse, material.albedo));
+
+				if (luminance(power) <= 0.f)
+				{
+					return;
+				}
+
+				const auto dir = fx::normalize(fx::add(intersection.normal, uniform_sphere(sampler.get2d(dimension + Sampler::HEMISPHERE))));
+				ray = Ray{ offset_origin(intersection.pos, intersection.normal), dir };
+			}
+		});
+	}
+
+	PixelResult Renderer::splatted_pixel(std::uint32_t x, std::uint32_t y, const Hit& primary) noexcept
+	{
+		const auto index = y * camera.width + x;
+		const auto ray = Ray{ camera.pos, camera.rays[index] };
+
+		const auto intersection = resolve(ray, primary);
+
+		// light paths never reach the sky, so rays escaping the scene still see it directly
+		if (intersection.material == nullptr)
+		{
+			return { fx::add(splats[index], miss(ray.dir)), std::numeric_limits<float>::max(), {}, {} };
+		}
+
+		return { splats[index], intersection.distance, intersection.normal, intersection.material->diffuse };
+	}
+
+	PixelResult Renderer::occlusion_pixel(std::uint32_t x, std::uint32_t y, const Hit& primary) noexcept
+	{
+		const auto index = y * camera.width + x;
+		const auto ray = Ray{ camera.pos, camera.rays[index] };
+
+		const auto intersection = resolve(ray, primary);
+
+		if (intersection.material == nullptr)
+		{
+			return { miss(ray.dir), std::numeric_limits<float>::max(), {}, {} };
+		}
+
+		const Sampler sampler{ _options.sampling, x, y, static_cast<std::uint32_t>(frame_count) - 1 };
+		const auto origin = offset_origin(intersection.pos, intersection.normal);
+
+		auto open = 0u;
+
+		for (auto sample = 0u; sample < _options.paths; sample++)
+		{
+			const auto uv = sampler.split(sample, _options.paths).get2d(Sampler::HEMISPHERE);
+			const auto dir = fx::normalize(fx::add(intersection.normal, uniform_sphere(uv)));
+
+			if (!any_hit(Ray{ origin, dir }, ::OCCLUSION_DISTANCE))
+			{
+				open++;
+			}
+		}
+
+		const auto occlusion = static_cast<float>(open) / std::max(_options.paths, 1u);
+		const auto lambert = sees_light(intersection) ? fx::dot(intersection.normal, shadow_map.direction()) : 0.f;
+
+		const auto& material = *intersection.material;
+		const auto shade = occlusion * (::AMBIENT + (1.f - ::AMBIENT) * lambert);
+
+		return { fx::add(fx::scale(material.diffuse, shade), material.emission), intersection.distance, intersection.normal, material.diffuse, intersection.primitive };
+	}
+
+	void Renderer::build_shadow_map(void) noexcept
+	{
+		fx::Timer timer{};
+
+		shadow_map.prepare(scene, light);
+		shadowed_light = light;
+
+		if (shadow_map.empty())
+		{
+			return;
+		}
+
+		std::vector<std::uint32_t> rows(ShadowMap::RESOLUTION);
+		std::iota(rows.begin(), rows.end(), 0u);
+
+		std::for_each(std::execution::par, rows.begin(), rows.end(), [&](std::uint32_t y)
+		{
+			for (auto x = 0u; x < ShadowMap::RESOLUTION; x++)
+			{
+				const auto hit = closest_hit(shadow_map.texel_ray(x, y));
+
+				if (hit.primitive != Hit::NONE)
+				{
+					shadow_map.store(x, y, hit.distance);
+				}
+			}
+		});
+
+		log(std::format("traced {0}x{0} shadow map for the directional light in {1:.1f} ms", ShadowMap::RESOLUTION, timer.milliseconds()));
+	}
+
+	bool Renderer::sees_light(const Intersection& intersection) noexcept
+	{
+		const auto& dir = shadow_map.direction();
+
+		if (fx::dot(intersection.normal, dir) <= 0.f)
+		{
+			return false;
+		}
+
+		switch (shadow_map.lookup(intersection.pos))
+		{
+			case Visibility::LIT: return true;
+			case Visibility::SHADOWED: return false;
+			default: break;
+		}
+
+		// near silhouettes the map cannot tell, so fall back to a shadow ray
+		return !any_hit(Ray{ offset_origin(intersection.pos, intersection.normal), dir });
+	}
+
+	Ray Renderer::reflect_intersection(const Intersection& intersection, const Ray& ray, const Sampler& sampler, std::uint32_t dimension) noexcept
+	{
+		const auto pos = offset_origin(intersection.pos, intersection.normal);
+
+		// roughness controls the random dispersion of reflection rays
+		const auto gain = .2f * intersection.material->roughness;
+		const auto roughness_noise = ::jitter(sampler.get3d(dimension + Sampler::ROUGHNESS), gain);
+		const auto normal = fx::add(intersection.normal, roughness_noise);
+
+		const auto dir = fx::reflect(ray.dir, normal);
+
+		return Ray{ pos, dir };
+	}
+
+	Hit Renderer::closest_hit(const Ray& ray, float max) noexcept
+	{
+		if (acceleration == Acceleration::GRID)
+		{
+			return grid.intersect(ray, max);
+		}
+
+		return bvh.intersect(ray, max);
+	}
+
+	bool Renderer::any_hit(const Ray& ray, float max) noexcept
+	{
+		if (acceleration == Acceleration::GRID)
+		{
+			return grid.occluded(ray, max);
+		}
+
+		return bvh.occluded(ray, max);
+	}
+
+	Hit Renderer::primary_hit(const Ray& ray, const Hit& cached) noexcept
+	{
+		auto distance = 0.f;
+
+		// jitter mostly keeps a ray on the sphere its pixel sees, and then only something in front of that
+		// sphere can be closer, which a traversal bounded by its distance rejects near the root
+		if (cached.primitive != Hit::NONE && intersect_sphere(ray, scene.spheres()[cached.primitive], distance))
+		{
+			if (const auto nearer = closest_hit(ray, distance); nearer.primitive != Hit::NONE)
+			{
+				return nearer;
+			}
+
+			return { distance, cached.primitive };
+		}
+
+		return closest_hit(ray);
+	}
+
+	Intersection Renderer::resolve(const Ray& ray, const Hit& hit) noexcept
+	{
+		//no object was hit
+		if (hit.primitive == Hit::NONE) [[likely]]
+		{
+			return { {}, {}, std::numeric_limits<float>::max(), nullptr, Hit::NONE };
+		}
+
+		const auto& sphere = scene.spheres()[hit.primitive];
+
+		auto distance = hit.distance;
+		auto pos = hit_position(ray, distance);
+
+		if (_options.precision == Precision::DOUBLE || distance < ::CLOSE_HIT * sphere.radius)
+		{
+			// traversal already settled which sphere is hit, so a double miss is only a grazing ray
+			// that the float test rounded the other way, and the float position stands
+			if (auto refined = static_cast<double>(distance); intersect_sphere(ray, sphere, refined))
+			{
+				distance = static_cast<float>(refined);
+				pos = hit_position(ray, refined);
+			}
+		}
+
+		const auto toward = fx::subtract(pos, scene.center(hit.primitive));
+		const auto normal = fx::normalize(toward);
+
+		Intersection intersection{ pos, normal, distance, &scene.material(hit.primitive), hit.primitive };
+
+#ifdef SIMPLE_SHADOWS
+		const auto scalar = std::clamp(fx::dot(light, intersection.normal), 0.f, 1.0f);
+		intersection.color = fx::scale(intersection.color, scalar);
+#endif
+
+		return intersection;
+	}
+
+	Intersection Renderer::trace_ray(const Ray& ray) noexcept
+	{
+		return resolve(ray, closest_hit(ray));
+	}
+
+	PixelResult Renderer::render_pixel(std::uint32_t x, std::uint32_t y, fx::platform_type blur, const Hit* primary) noexcept
+	{
+		fx::vec3 direct{}, indirect{};
+		fx::vec3 normal{}, albedo{};
+
+		auto dir = camera.rays[y * camera.width + x];
+		auto pos = camera.pos;
+
+		auto depth = std::numeric_limits<float>::max();
+		auto primitive = Hit::NONE;
+
+		Intersection intersection{};
+
+		// one sample per pixel per accumulated frame
+		const auto frame = static_cast<std::uint32_t>(frame_count) - 1;
+		const Sampler sampler{ _options.sampling, x, y, frame };
+
+		for (auto bounce = 0u; bounce < _options.bounces; bounce++)
+		{
+			// first dimension of this bounce's block
+			const auto dimension = bounce * Sampler::DIMENSIONS_PER_BOUNCE;
+
+			const auto dir_noised = noise(dir, sampler.get3d(dimension + Sampler::LENS), blur);
+			const auto ray = Ray{ camera.pos, dir_noised };
+
+			if (bounce == 0 && primary != nullptr)
+			{
+				intersection = resolve(ray, primary_hit(ray, *primary));
+			}
+
+			else
+			{
+				intersection = trace_ray(ray);
+			}
+
+			if (intersection.material == nullptr)
+			{
+				direct = fx::add(direct, miss(dir_noised));
+
+				break;
+			}
+
+			if (bounce == 0)
+			{
+				primitive = intersection.primitive;
+				depth = intersection.distance;
+				normal = intersection.normal;
+				albedo = intersection.material->diffuse;
+			}
+
+			const auto& material = *intersection.material;
+			
+			const auto diffuse = material.diffuse;
+
+			const auto inverted = fx::invert(dir_noised);
+			const auto cos_theta = fx::dot(inverted, intersection.normal);
+
+			if (cos_theta >= 0)
+			{
+				auto indirect = fx::broadcast<3>(0.f);
+				if (material.albedo > 0)
+				{
+					indirect = indirect_illumination(intersection, sampler, dimension, bounce == 0);
+					indirect = fx::scale(indirect, material.albedo);
+				}
+
+				const auto value = ((cos_theta + 1.f) * .5f);
+
+				const auto scalar = value * (1 - material.metallic);
+				const auto capture = lerp(diffuse, indirect, 1 - scalar);
+				const auto scaled = fx::scale(capture, scalar * .8f);
+
+				direct = fx::add(direct, scaled);
+			}
+
+
+			// emitters are seen directly; light they cast on other surfaces arrives through one light sample per bounce
+			direct = fx::add(direct, material.emission);
+
+			if (!light_tree.empty() || !environment.empty())
+			{
+				const auto restir_pixel = bounce == 0 && _options.lights == LightSampling::RESTIR ? y * camera.width + x : NO_PIXEL;
+				const auto lit = direct_illumination(intersection, sampler, dimension, restir_pixel);
+				direct = fx::add(direct, fx::scale(lit, 1 - material.metallic));
+			}
+
+			if (_options.mode == RenderMode::PHOTONMAP)
+			{
+				// lambertian brdf over the caustic flux density around the point
+				const auto caustic = fx::multiply(diffuse, photon_map.gather(intersection.pos, intersection.normal));
+				direct = fx::add(direct, fx::scale(caustic, (1 - material.metallic) / fx::pi()));
+			}
+
+			if (material.metallic == 0)
+			{
+				// non-reflective surfaces
+				break;
+			}
+
+			dir = reflect_intersection(intersection, ray, sampler, dimension).dir;
+		}
+
+		return { direct, depth, normal, albedo, primitive };
+	}
+
+	float Renderer::defocus(const Hit& focus_hit) const noexcept
+	{
+		auto depth = std::numeric_limits<float>::max();
+		if (focus_hit.primitive != Hit::NONE)
+		{
+			depth = focus_hit.distance;
+		}
+
+		const auto depth_difference = depth - camera.depth;
+
+		// the tenth power as products, which std::pow would otherwise take through double
+		const auto squared = depth_difference * depth_difference;
+		const auto fourth = squared * squared;
+
+		return 1.f - std::exp(-(fourth * fourth * squared));
+	}
+
+	void Renderer::accumulate_sample(std::uint32_t index, const PixelResult& sample, float focus) noexcept
+	{
+		auto result = sample.output;
+		auto brightness = 1.f;
+
+		if (camera.show_depth)
+		{
+			if (focus < .5f)
+			{
+				brightness = 1.2f;
+				result = fx::scale(result, brightness);
+			}
+		}
+
+		auto& data = accumulated_data[index];
+		data = fx::add(data, result);
+
+		// a sample whose first hit has the tracked material is its diffuse colour times this, plus emission
+		if (!reshading.empty() && sample.primitive != Hit::NONE && scene.material_id(sample.primitive) == reshaded_material)
+		{
+			const auto& material = scene.material(sample.primitive);
+			const auto shading = fx::subtract(result, fx::scale(material.emission, brightness));
+
+			for (auto channel = 0; channel < 3; channel++)
+			{
+				reshading[index][channel] += shading[channel] / material.diffuse[channel];
+			}
+
+			reshading_hits[index] += 1.f;
+		}
+
+		features.depth[index] += std::min(sample.depth, SKY_DEPTH);
+		features.normal[index] = fx::add(features.normal[index], sample.normal);
+		features.albedo[index] = fx::add(features.albedo[index], sample.albedo);
+
+		frame_color[index] = result;
+		frame_features.depth[index] = std::min(sample.depth, SKY_DEPTH);
+		frame_features.normal[index] = sample.normal;
+		frame_features.albedo[index] = sample.albedo;
+	}
+
+	void Renderer::reset_accumulation(void) noexcept
+	{
+		const auto size = _options.width * _options.height;
+
+		frame_count = 1.f;
+
+		delete[] accumulated_data;
+		accumulated_data = new fx::vec3[size]();
+
+		for (auto i = 0u; i < size; i++)
+		{
+			accumulated_data[i] = fx::broadcast<3>(0.f);
+		}
+
+		features.reset(size);
+
+		std::fill(reshading.begin(), reshading.end(), fx::broadcast<3>(0.f));
+		std::fill(reshading_hits.begin(), reshading_hits.end(), 0.f);
+
+		// the accumulation averages one photon pass per frame, so the radius schedule starts over with it
+		photon_map.restart();
+	}
+
+	std::optional<std::uint16_t> Renderer::material_at(std::uint32_t x, std::uint32_t y) const noexcept
+	{
+		if (!gbuffer.valid() || x >= _options.width || y >= _options.height)
+		{
+			return std::nullopt;
+		}
+
+		const auto& hit = gbuffer.primary(y * _options.width + x);
+
+		if (hit.primitive == Hit::NONE)
+		{
+			return std::nullopt;
+		}
+
+		return scene.material_id(hit.primitive);
+	}
+
+	void Renderer::track_material(std::uint32_t index) noexcept
+	{
+		reshaded_material = index;
+
+		if (index == NO_MATERIAL)
+		{
+			reshading.clear();
+			reshading_hits.clear();
+			return;
+		}
+
+		const auto size = _options.width * _options.height;
+
+		reshading.assign(size, fx::broadcast<3>(0.f));
+		reshading_hits.assign(size, 0.f);
+	}
+
+	bool Renderer::reshade(std::uint32_t index) noexcept
+	{
+		// light paths land in pixels other than the one whose primary hit is tracked
+		if (index == NO_MATERIAL || index != reshaded_material || _options.mode == RenderMode::LIGHTTRACE || !::first_hit_only(scene.materials))
+		{
+			return false;
+		}
+
+		const auto& before = shaded_materials[index].diffuse;
+		const auto& after = scene.materials[index].diffuse;
+
+		// the sums were divided by the old colour, so a channel it had at zero left nothing to rescale
+		if (before[0] <= 0.f || before[1] <= 0.f || before[2] <= 0.f)
+		{
+			return false;
+		}
+
+		const auto delta = fx::subtract(after, before);
+		const auto size = _options.width * _options.height;
+
+		for (auto i = 0u; i < size; i++)
+		{
+			accumulated_data[i] = fx::add(accumulated_data[i], fx::multiply(delta, reshading[i]));
+			features.albedo[i] = fx::add(features.albedo[i], fx::scale(delta, reshading_hits[i]));
+		}
+
+		return true;
+	}
+
+	bool Renderer::edit_material(std::uint16_t index, const Material& material) noexcept
+	{
+		if (index >= scene.materials.size())
+		{
+			warning(std::format("material index {} out of range", index));
+			return false;
+		}
+
+		scene.materials[index] = material;
+		return true;
+	}
+
+	void Renderer::present(const std::uint32_t* target, olc::PixelGameEngine* pge) noexcept
+	{
+		pge->Clear(olc::BLACK);
+
+		const auto width = camera.width;
+		const auto height = camera.height;
+
+		// each pixel is drawn as a circle as wide as its defocus blur and fades with distance from focus
+		for (auto y = 0u; y < height; y++)
+		{
+			for (auto x = 0u; x < width; x++)
+			{
+				const auto index = y * width + x;
+				const auto packed = target[index];
+				const auto focus = defocus(gbuffer.primary(index));
+
+				const auto red = static_cast<std::uint8_t>(packed >> 16);
+				const auto green = static_cast<std::uint8_t>(packed >> 8);
+				const auto blue = static_cast<std::uint8_t>(packed);
+				const auto alpha = static_cast<std::uint8_t>(255.f * focus);
+
+				pge->DrawCircle(x, y, static_cast<std::int32_t>(::blur_radius(focus)), olc::Pixel{ red, green, blue, alpha });
+			}
+		}
+	}
+
+	void Renderer::render_to(std::uint32_t* target, olc::PixelGameEngine* pge) noexcept
+	{
+		fx::Timer timer{};
+
+		const auto width = _options.width;
+		const auto height = _options.height;
+
+		camera.update(frametime, pge);
+
+		if (camera.moved)
+		{
+			reset_accumulation();
+			gbuffer.invalidate();
+
+			camera.moved = false;
+		}
+
+		// geometry never changes after loading, so only turning the light invalidates its shadows
+		if (_options.mode == RenderMode::AMBIENT_OCCLUSION && (light[0] != shadowed_light[0] || light[1] != shadowed_light[1] || light[2] != shadowed_light[2]))
+		{
+			build_shadow_map();
+			reset_accumulation();
+		}
+
+		// visibility does not depend on materials, so an edit to the material table keeps the
+		// acceleration structures and the cached primary hits and only restarts the accumulation; shadow
+		// and indirect rays are traced again, since what they reach is weighted by the new materials.
+		// the one exception is a diffuse-only edit of the tracked material, which is rescaled in place
+		const auto change = ::compare(shaded_materials, scene.materials);
+		const auto edited = ::edited_material(shaded_materials, scene.materials);
+
+		if (change == ::MaterialChange::DIFFUSE && reshade(edited))
+		{
+			shaded_materials = scene.materials;
+
+			// both hold colours or targets shaded with the old diffuse colour
+			svgf.reset();
+			restir.reset();
+		}
+
+		else if (change != ::MaterialChange::NONE)
+		{
+			// the material edited now is likely to be edited next, so it is the one tracked from here on
+			track_material(edited);
+
+			shaded_materials = scene.materials;
+			svgf.reset();
+
+			if (change == ::MaterialChange::EMISSION)
+			{
+				light_tree.build(scene);
+				restir.reset();
+			}
+
+			// photons are aimed at metals and weighted by emission, neither of which a diffuse edit touches
+			if (_options.mode == RenderMode::PHOTONMAP && change != ::MaterialChange::DIFFUSE)
+			{
+				photon_map.aim(scene, light_tree, light);
+			}
+
+			// cached records saw the old materials through their paths
+			if (_options.irradiance == Irradiance::CACHE)
+			{
+				irradiance_cache.reset();
+			}
+
+			// the g-buffer survives the reset, so the frames below still start from the cached primary hits
+			reset_accumulation();
+		}
+
+		// while the camera is still, the unjittered primary hits are traced once and reused by every frame
+		const auto primary_cached = gbuffer.valid();
+
+		if (_options.mode == RenderMode::PHOTONMAP)
+		{
+			trace_photons();
+		}
+
+		else if (_options.mode == RenderMode::LIGHTTRACE)
+		{
+			trace_light_paths();
+		}
+
+		// rows run in parallel. a pixel writes only its own accumulation, features, g-buffer hit and reservoir,
+		// and resampling reads the previous frame's reservoirs alone; the irradiance cache and the guide's
+		// building trees take concurrent updates through atomics, and everything else is read-only until
+		// the loop is done
+		std::vector<std::uint32_t> rows(height);
+		std::iota(rows.begin(), rows.end(), 0u);
+
+		std::for_each(std::execution::par, rows.begin(), rows.end(), [&](std::uint32_t y)
+		{
+			for (auto x = 0u; x < width; ++x)
+			{
+//#define TESTING
+#ifndef TESTING
+				auto index = (y * width) + x;
+
+				fx::vec3 result{};
+
+				// TODO: reincorporate pixel sampling
+				//for (auto i = 0; i < _options.samples; i++)
+				//{
+				// result = fx::add(result, iteration.output);
+				//}
+				// const auto divisor = fx::native(1) / _options.samples;
+				// result = fx::scale(result, divisor);
+
+				//const auto initial_sample = render_pixel(x, y);
+
+				auto dir = camera.rays[y * camera.width + x];
+				auto pos = camera.pos;
+
+				const auto ray = Ray{ pos, dir };
+
+				auto& hit = gbuffer.primary(index);
+
+				if (!primary_cached)
+				{
+					hit = closest_hit(ray);
+				}
+
+				const auto focus = defocus(hit);
+				const auto blur = ::blur_radius(focus);
+
+				const auto real_sample = _options.mode == RenderMode::LIGHTTRACE ? splatted_pixel(x, y, hit)
+					: _options.mode == RenderMode::AMBIENT_OCCLUSION ? occlusion_pixel(x, y, hit)
+					: render_pixel(x, y, blur, &hit);
+				result = real_sample.output;
+
+				accumulate_sample(index, real_sample, focus);
 #else
 				const auto index = (y * width) + x;
 				target[index] = RGB(render_pixel(x, y));
 #endif
 			}
+		});
+
+		gbuffer.commit();
+
+		if (_options.mode == RenderMode::PHOTONMAP)
+		{
+			photon_map.advance();
+		}
+
+		if (_options.lights == LightSampling::RESTIR)
+		{
+			restir.swap();
+		}
+
+		if (_options.guiding == Guiding::SDTREE && ::traces_paths(_options.mode) && guide.advance())
+		{
+			log(std::format("path guiding iteration {} refined into {} spatial leaves", guide.iteration(), guide.leaf_count()));
+		}
+
+		const auto size = width * height;
+		const auto divisor = 1 / frame_count;
+		const auto exposure = std::exp2(_options.exposure);
+
+		// without a filter the mean is folded into the exposure, and the pass reads the accumulation directly
+		if (_options.filter == Filter::NONE)
+		{
+			post_process(accumulated_data, target, size, exposure * divisor);
+		}
+
+		else
+		{
+			resolved.resize(size);
+
+			if (_options.filter == Filter::SVGF)
+			{
+				svgf.apply(frame_color, frame_features, camera, resolved);
+			}
+
+			else
+			{
+				for (auto i = 0u; i < size; i++)
+				{
+					resolved[i] = fx::scale(accumulated_data[i], divisor);
+				}
+
+				denoiser.apply(resolved, features, divisor, width, height);
+			}
+
+			post_process(resolved.data(), target, size, exposure);
+		}
+
+		if (pge != nullptr)
+		{
+			present(target, pge);
 		}
 
 		frametime = timer.milliseconds();
@@ -1,6 +1,7 @@
 import std;
 
 #include "arguments.h"
+#include "description.h"
 #include "log.h"
 
 // arguments.cpp
@@ -8,6 +9,13 @@ import std;
 
 namespace
 {
+	// the path tracer and photon mapper send paths per hit for indirect light, ambient occlusion sends
+	// that many occlusion rays per pixel, and every other mode ignores the count
+	bool uses_paths(luma::RenderMode mode) noexcept
+	{
+		return mode == luma::RenderMode::PATHTRACE || mode == luma::RenderMode::PHOTONMAP || mode == luma::RenderMode::AMBIENT_OCCLUSION;
+	}
+
 	std::vector<std::string> split(std::string text, const std::string& delimiter)
 	{
 		return text
@@ -60,6 +68,24 @@ namespace
 		bool success = (ec == std::errc() && ptr == end);
 		return { success, result };
 	}
+
+	struct ProcessFloatResult
+	{
+		bool success;
+		float result;
+	};
+
+	ProcessFloatResult parse_float(const std::string& input)
+	{
+		float result = 0.f;
+		const char* start = input.data();
+		const char* end = start + input.size();
+
+		auto [ptr, ec] = std::from_chars(start, end, result);
+
+		bool success = (ec == std::errc() && ptr == end);
+		return { success, result };
+	}
 }
 
 namespace
@@ -73,6 +99,20 @@ namespace
 		BOUNCES,
 		CONTEXT,
 		PATHS,
+		ACCELERATION,
+		PARTICLES,
+		EXPORT,
+		SCENE,
+		SAMPLER,
+		DENOISE,
+		LIGHTS,
+		ENVIRONMENT,
+		GUIDING,
+		IRRADIANCE,
+		ISA,
+		PRECISION,
+		EXPOSURE,
+		VALIDATE,
 	};
 
 	static const std::unordered_map<std::string, ArgumentType> _arguments_map
@@ -84,6 +124,20 @@ namespace
 		{ "samples", ArgumentType::SAMPLES },
 		{ "context", ArgumentType::CONTEXT },
 		{ "paths", ArgumentType::PATHS },
+		{ "acceleration", ArgumentType::ACCELERATION },
+		{ "particles", ArgumentType::PARTICLES },
+		{ "export", ArgumentType::EXPORT },
+		{ "scene", ArgumentType::SCENE },
+		{ "sampler", ArgumentType::SAMPLER },
+		{ "denoise", ArgumentType::DENOISE },
+		{ "lights", ArgumentType::LIGHTS },
+		{ "environment", ArgumentType::ENVIRONMENT },
+		{ "guiding", ArgumentType::GUIDING },
+		{ "irradiance", ArgumentType::IRRADIANCE },
+		{ "isa", ArgumentType::ISA },
+		{ "precision", ArgumentType::PRECISION },
+		{ "exposure", ArgumentType::EXPOSURE },
+		{ "validate", ArgumentType::VALIDATE },
 	};
 }
 
@@ -176,10 +230,10 @@ namespace luma
 
 					case PATHS:
 					{
-						if (_options.mode != RenderMode::PATHTRACE)
+						if (!::uses_paths(_options.mode))
 						{
 							// warn about arguments but keep processing in case the render mode is set afterwards on the command line
-							warning(std::format("path count `{}` will be ignored if render mode is not set to \"pathtrace\"", value));
+							warning(std::format("path count `{}` will be ignored if render mode is not set to \"pathtrace\", \"photonmap\" or \"ao\"", value));
 						}
 
 						const auto [success, result] = parse_integer(value);
@@ -216,6 +270,150 @@ namespace luma
 						_options.context = _context_map.at(value);
 					} break;
 
+					case ACCELERATION:
+					{
+						if (!_acceleration_map.contains(value))
+						{
+							log(std::format("unrecognized acceleration structure `{}`", value));
+							continue;
+						}
+
+						_options.acceleration = _acceleration_map.at(value);
+					} break;
+
+					case SAMPLER:
+					{
+						if (!_sampling_map.contains(value))
+						{
+							log(std::format("unrecognized sampler `{}`", value));
+							continue;
+						}
+
+						_options.sampling = _sampling_map.at(value);
+					} break;
+
+					case DENOISE:
+					{
+						if (!_filter_map.contains(value))
+						{
+							log(std::format("unrecognized denoiser `{}`", value));
+							continue;
+						}
+
+						_options.filter = _filter_map.at(value);
+					} break;
+
+					case LIGHTS:
+					{
+						if (!_light_sampling_map.contains(value))
+						{
+							log(std::format("unrecognized light sampler `{}`", value));
+							continue;
+						}
+
+						_options.lights = _light_sampling_map.at(value);
+					} break;
+
+					case PARTICLES:
+					{
+						_options.particles = value;
+					} break;
+
+					case EXPORT:
+					{
+						_options.export_path = value;
+					} break;
+
+					case ENVIRONMENT:
+					{
+						_options.environment = value;
+					} break;
+
+					case GUIDING:
+					{
+						if (!_guiding_map.contains(value))
+						{
+							log(std::format("unrecognized guiding `{}`", value));
+							continue;
+						}
+
+						_options.guiding = _guiding_map.at(value);
+					} break;
+
+					case IRRADIANCE:
+					{
+						if (!_irradiance_map.contains(value))
+						{
+							log(std::format("unrecognized irradiance `{}`", value));
+							continue;
+						}
+
+						_options.irradiance = _irradiance_map.at(value);
+					} break;
+
+					case ISA:
+					{
+						if (!_isa_map.contains(value))
+						{
+							log(std::format("unrecognized instruction set `{}`", value));
+							continue;
+						}
+
+						_options.isa = _isa_map.at(value);
+					} break;
+
+					case PRECISION:
+					{
+						if (!_precision_map.contains(value))
+						{
+							log(std::format("unrecognized precision `{}`", value));
+							continue;
+						}
+
+						_options.precision = _precision_map.at(value);
+					} break;
+
+					case EXPOSURE:
+					{
+						const auto [success, result] = parse_float(value);
+
+						if (!success)
+						{
+							log(std::format("unrecognized exposure `{}`", value));
+							continue;
+						}
+
+						_options.exposure = result;
+					} break;
+
+					case VALIDATE:
+					{
+						if (!_validation_map.contains(value))
+						{
+							log(std::format("unrecognized validation `{}`", value));
+							continue;
+						}
+
+						_options.validation = _validation_map.at(value);
+					} break;
+
+					case SCENE:
+					{
+						if (std::filesystem::path(value).extension() == PARTICLE_EXTENSION)
+						{
+							_options.particles = value;
+							continue;
+						}
+
+						// loaded immediately so that options given after --scene= override the file's render settings
+						if (!load_scene(value, _description, _options))
+						{
+							continue;
+						}
+
+						log(std::format("loaded {} spheres and {} materials from `{}`", _description.spheres.size(), _description.materials.size(), value));
+					} break;
+
 					default:
 					{
 						log(std::format("unrecognized option `{}`", option_string));
@@ -10,12 +10,21 @@ namespace luma
 	{
 		RAYTRACE,
 		PATHTRACE,
+		// path tracing plus caustics gathered from progressive photon passes
+		PHOTONMAP,
+		// paths started from the emitters and splatted into whichever pixel sees them
+		LIGHTTRACE,
+		// preview of ambient occlusion and simple lighting from the directional light
+		AMBIENT_OCCLUSION,
 	};
 
 	static const std::unordered_map<std::string, RenderMode> _render_mode_map
 	{
 		{ "raytrace", RenderMode::RAYTRACE },
 		{ "pathtrace", RenderMode::PATHTRACE },
+		{ "photonmap", RenderMode::PHOTONMAP },
+		{ "lighttrace", RenderMode::LIGHTTRACE },
+		{ "ao", RenderMode::AMBIENT_OCCLUSION },
 	};
 
 	enum class Context
@@ -23,6 +32,8 @@ namespace luma
 		INTERACTIVE,
 		DIRECTX,
 		HEADLESS,
+		// times the simd kernels against their scalar counterparts and exits
+		BENCHMARK,
 	};
 
 	static const std::unordered_map<std::string, Context> _context_map
@@ -30,14 +41,159 @@ namespace luma
 		{ "interative", Context::INTERACTIVE },
 		{ "directx", Context::DIRECTX },
 		{ "headless", Context::HEADLESS },
+		{ "benchmark", Context::BENCHMARK },
 	};
 
+	enum class Acceleration
+	{
+		AUTO,
+		BVH,
+		GRID,
+	};
+
+	static const std::unordered_map<std::string, Acceleration> _acceleration_map
+	{
+		{ "auto", Acceleration::AUTO },
+		{ "bvh", Acceleration::BVH },
+		{ "grid", Acceleration::GRID },
+	};
+
+	enum class Sampling
+	{
+		RANDOM,
+		SOBOL,
+		BLUE_NOISE,
+	};
+
+	static const std::unordered_map<std::string, Sampling> _sampling_map
+	{
+		{ "random", Sampling::RANDOM },
+		{ "sobol", Sampling::SOBOL },
+		{ "bluenoise", Sampling::BLUE_NOISE },
+	};
+
+	enum class Filter
+	{
+		NONE,
+		ATROUS,
+		SVGF,
+	};
+
+	static const std::unordered_map<std::string, Filter> _filter_map
+	{
+		{ "none", Filter::NONE },
+		{ "atrous", Filter::ATROUS },
+		{ "svgf", Filter::SVGF },
+	};
+
+	enum class LightSampling
+	{
+		TREE,
+		RESTIR,
+	};
+
+	static const std::unordered_map<std::string, LightSampling> _light_sampling_map
+	{
+		{ "tree", LightSampling::TREE },
+		{ "restir", LightSampling::RESTIR },
+	};
+
+	enum class Guiding
+	{
+		OFF,
+		SDTREE,
+	};
+
+	static const std::unordered_map<std::string, Guiding> _guiding_map
+	{
+		{ "off", Guiding::OFF },
+		{ "sdtree", Guiding::SDTREE },
+	};
+
+	enum class Irradiance
+	{
+		TRACE,
+		CACHE,
+	};
+
+	static const std::unordered_map<std::string, Irradiance> _irradiance_map
+	{
+		{ "trace", Irradiance::TRACE },
+		{ "cache", Irradiance::CACHE },
+	};
+
+	// precision hit positions are resolved in; traversal always runs in float, and FLOAT still repeats
+	// close hits in double, where float cannot place them accurately
+	enum class Precision
+	{
+		FLOAT,
+		DOUBLE,
+	};
+
+	static const std::unordered_map<std::string, Precision> _precision_map
+	{
+		{ "float", Precision::FLOAT },
+		{ "double", Precision::DOUBLE },
+	};
+
+	// how much of a particle file is checked when it is opened; HEADER only reads the header, so mapping
+	// the file costs nothing until the renderer touches its pages, and FULL also checks every material id
+	// and every bvh node, which pages in most of the file
+	enum class Validation
+	{
+		HEADER,
+		FULL,
+	};
+
+	static const std::unordered_map<std::string, Validation> _validation_map
+	{
+		{ "header", Validation::HEADER },
+		{ "full", Validation::FULL },
+	};
+
+	// instruction set the intersection and post-process kernels are compiled for; AUTO takes the
+	// widest one the processor supports
+	enum class Isa
+	{
+		AUTO,
+		SSE2,
+		AVX2,
+		AVX512,
+		NEON,
+	};
+
+	static const std::unordered_map<std::string, Isa> _isa_map
+	{
+		{ "auto", Isa::AUTO },
+		{ "sse2", Isa::SSE2 },
+		{ "avx2", Isa::AVX2 },
+		{ "avx512", Isa::AVX512 },
+		{ "neon", Isa::NEON },
+	};
+
+	// extension of binary particle files, which --scene= maps instead of parsing
+	static constexpr auto PARTICLE_EXTENSION = ".lpf";
+
 	struct Options
 	{
 		std::uint32_t width, height;
 		std::uint32_t samples, bounces, paths;
 		RenderMode mode;
 		Context context = Context::INTERACTIVE;
+		Acceleration acceleration = Acceleration::AUTO;
+		Sampling sampling = Sampling::SOBOL;
+		Filter filter = Filter::NONE;
+		LightSampling lights = LightSampling::TREE;
+		Guiding guiding = Guiding::OFF;
+		Irradiance irradiance = Irradiance::TRACE;
+		Isa isa = Isa::AUTO;
+		Precision precision = Precision::FLOAT;
+		Validation validation = Validation::HEADER;
+		// stops of exposure applied before the display curve
+		float exposure = 0.f;
+		std::string particles, export_path;
+		// equirectangular radiance map that replaces the sky gradient when given
+		std::string environment;
 	};
 
 	extern Options _options;
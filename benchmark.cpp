@@ -0,0 +1,445 @@
+import std;
+
+#include "olcPixelGameEngine.h"
+
+#include "flux/timer.h"
+#include "flux/vector.h"
+
+#include "benchmark.h"
+#include "bvh.h"
+#include "camera.h"
+#include "color.h"
+#include "kernels.h"
+#include "post.h"
+#include "renderer.h"
+#include "simd.h"
+#include "log.h"
+
+// benchmark.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	constexpr auto WIDTH = 1920u;
+	constexpr auto HEIGHT = 1080u;
+
+	// the fastest of this many runs is reported, which hides warmup and scheduling noise
+	constexpr auto REPEATS = 20u;
+
+	// convergence runs first render this many frames, which give the path guide its first iterations,
+	// and then this many more whose samples are measured; both count towards the time
+	constexpr auto WARMUP = 16u;
+	constexpr auto FRAMES = 64u;
+
+	template<typename F>
+	float fastest(F&& run) noexcept
+	{
+		auto best = std::numeric_limits<float>::max();
+
+		for (auto i = 0u; i < REPEATS; i++)
+		{
+			fx::Timer timer{};
+			run();
+			best = std::min(best, timer.milliseconds());
+		}
+
+		return best;
+	}
+
+	void report(const char* kernel, float scalar, const char* backend, float vector, float error) noexcept
+	{
+		luma::log(std::format("{:<16} scalar {:7.2f} ms  {:<6} {:7.2f} ms  {:5.2f}x  max error {:.2e}",
+			kernel, scalar, backend, vector, scalar / vector, error));
+	}
+
+	void report(const char* kernel, float scalar, float vector, float error) noexcept
+	{
+		::report(kernel, scalar, luma::simd::backend(), vector, error);
+	}
+
+	// every kernel variant this build has and the processor can run
+	std::vector<const luma::Kernels*> variants(void) noexcept
+	{
+		std::vector<const luma::Kernels*> out;
+
+		for (const auto& [name, isa] : luma::_isa_map)
+		{
+			if (const auto variant = luma::kernel_variant(isa))
+			{
+				out.push_back(variant);
+			}
+		}
+
+		return out;
+	}
+
+	// still frames of the loaded scene rendered headless; the variance is that of each pixel's accumulated
+	// mean, estimated from the spread of its per-frame luminance and averaged over the image
+	struct Convergence
+	{
+		float variance;
+		float milliseconds;
+	};
+
+	Convergence converge(std::uint32_t warmup, std::uint32_t frames) noexcept
+	{
+		luma::Renderer renderer{};
+
+		const auto size = luma::_options.width * luma::_options.height;
+
+		std::vector<std::uint32_t> target(size);
+		std::vector<double> sum(size), squares(size);
+
+		auto milliseconds = 0.f;
+
+		const auto render = [&]
+		{
+			fx::Timer timer{};
+			renderer.render_to(target.data(), nullptr);
+			milliseconds += timer.milliseconds();
+		};
+
+		for (auto i = 0u; i < warmup; i++)
+		{
+			render();
+		}
+
+		for (auto frame = 0u; frame < frames; frame++)
+		{
+			render();
+
+			for (auto i = 0u; i < size; i++)
+			{
+				const auto value = static_cast<double>(luma::luminance(renderer.frame_color[i]));
+
+				sum[i] += value;
+				squares[i] += value * value;
+			}
+		}
+
+		auto variance = 0.0;
+
+		for (auto i = 0u; i < size; i++)
+		{
+			const auto mean = sum[i] / frames;
+			variance += std::max(squares[i] / frames - mean * mean, 0.0) / frames;
+		}
+
+		return { static_cast<float>(variance / size), milliseconds };
+	}
+
+	float difference(const fx::vec3& a, const fx::vec3& b) noexcept
+	{
+		return std::max({ std::abs(a[0] - b[0]), std::abs(a[1] - b[1]), std::abs(a[2] - b[2]) });
+	}
+
+	// per-pixel ray generation as Camera::recompute_rays did it before going wide
+	void scalar_rays(const luma::Camera& camera, std::vector<fx::vec3>& rays) noexcept
+	{
+		rays.resize(camera.width * camera.height);
+
+		for (auto y = 0u; y < camera.height; y++)
+		{
+			for (auto x = 0u; x < camera.width; x++)
+			{
+				const auto one = fx::broadcast<2>(1.f);
+
+				fx::vec2 coordinate = { static_cast<float>(x) / camera.width,
+										static_cast<float>(y) / camera.height };
+
+				coordinate = fx::scale(coordinate, 2.f);
+				coordinate = fx::subtract(coordinate, one);
+
+				const auto extended = fx::vec4{ coordinate[0], coordinate[1], 1.f, 1.f };
+				const auto target = fx::apply(camera.projection_inverse, extended);
+
+				const auto truncated = fx::truncate(target);
+				const auto scalar = 1 / target[3];
+
+				const auto corrected = fx::scale(truncated, scalar);
+				const auto normalized = fx::normalize(corrected);
+				const auto padded = fx::extend(normalized, 0.f);
+
+				const auto ray = fx::apply(camera.view_inverse, padded);
+				rays[y * camera.width + x] = fx::truncate(ray);
+			}
+		}
+	}
+}
+
+namespace luma
+{
+	void benchmark(void) noexcept
+	{
+		log(std::format("benchmarking {}x{} with the {} backend", ::WIDTH, ::HEIGHT, simd::backend()));
+
+		std::mt19937 generator{ 1 };
+		std::uniform_real_distribution<float> radiance{ 0.f, 8.f };
+		std::uniform_real_distribution<float> component{ -1.f, 1.f };
+
+		const auto size = ::WIDTH * ::HEIGHT;
+
+		// ray generation, in each variant
+		{
+			Camera camera{ 70.f, .1f, 100.f, ::WIDTH, ::HEIGHT };
+			camera.place({ 0.f, -1.f, 5.f }, .3f, .2f, 70.f);
+
+			std::vector<fx::vec3> reference, rays(size);
+
+			const auto scalar = ::fastest([&] { ::scalar_rays(camera, reference); });
+			const auto basis = camera.ray_basis();
+
+			for (const auto variant : ::variants())
+			{
+				const auto vector = ::fastest([&] { variant->generate_rays(basis, ::WIDTH, ::HEIGHT, rays.data()); });
+
+				auto error = 0.f;
+				for (auto i = 0u; i < size; i++)
+				{
+					error = std::max(error, ::difference(reference[i], rays[i]));
+				}
+
+				::report("ray generation", scalar, variant->name, vector, error);
+			}
+		}
+
+		// post-processing of a resolved frame into packed pixels, in each variant and then across every
+		// core; the scalar reference encodes through std::pow, and the error is in 8-bit steps
+		{
+			std::vector<fx::vec3> colors(size);
+			std::vector<std::uint32_t> reference(size), packed(size);
+
+			for (auto& color : colors)
+			{
+				color = { radiance(generator), radiance(generator), radiance(generator) };
+			}
+
+			const auto scalar = ::fastest([&]
+			{
+				for (auto i = 0u; i < size; i++)
+				{
+					const auto display = tonemap(colors[i]);
+
+					auto func = [&](std::size_t channel)
+					{
+						return static_cast<std::uint32_t>(255.f * encode_srgb(display[channel]) + .5f);
+					};
+
+					reference[i] = (func(0) << 16) | (func(1) << 8) | func(2);
+				}
+			});
+
+			auto error = [&]
+			{
+				auto out = 0.f;
+
+				for (auto i = 0u; i < size; i++)
+				{
+					for (auto shift : { 0u, 8u, 16u })
+					{
+						const auto a = static_cast<float>((reference[i] >> shift) & 0xFF);
+						const auto b = static_cast<float>((packed[i] >> shift) & 0xFF);
+						out = std::max(out, std::abs(a - b));
+					}
+				}
+
+				return out;
+			};
+
+			for (const auto variant : ::variants())
+			{
+				const auto vector = ::fastest([&] { variant->tonemap(colors.data(), packed.data(), size, 1.f, srgb_table()); });
+				::report("post-process", scalar, variant->name, vector, error());
+			}
+
+			const auto parallel = ::fastest([&] { post_process(colors.data(), packed.data(), size, 1.f); });
+			::report("post-process", scalar, "tiled", parallel, error());
+		}
+
+		// closest-hit traversal of a random sphere cloud; there is no scalar traversal any more, so each
+		// variant is measured against the first, and the error is the share of rays whose closest sphere
+		// differs, which fused multiply-adds change for a few grazing hits
+		{
+			std::uniform_real_distribution<float> coordinate{ -50.f, 50.f };
+			std::uniform_real_distribution<float> radius{ .1f, .6f };
+
+			std::vector<PackedSphere> spheres(200'000);
+
+			for (auto& sphere : spheres)
+			{
+				sphere = { coordinate(generator), coordinate(generator), coordinate(generator), radius(generator) };
+			}
+
+			BVH bvh{};
+			const auto order = bvh.build(spheres);
+
+			std::vector<PackedSphere> sorted(spheres.size());
+			for (auto i = 0u; i < sorted.size(); i++)
+			{
+				sorted[i] = spheres[order[i]];
+			}
+
+			bvh.attach(sorted);
+
+			std::vector<Ray> rays(500'000);
+
+			for (auto& ray : rays)
+			{
+				ray.pos = { coordinate(generator), coordinate(generator), coordinate(generator) };
+				ray.dir = fx::normalize(fx::vec3{ component(generator), component(generator), component(generator) });
+			}
+
+			std::vector<std::uint32_t> reference, primitives(rays.size());
+			auto baseline = 0.f;
+
+			for (const auto variant : ::variants())
+			{
+				const auto vector = ::fastest([&]
+				{
+					for (auto i = 0u; i < rays.size(); i++)
+					{
+						primitives[i] = variant->intersect(bvh.nodes(), sorted, rays[i], std::numeric_limits<float>::max()).primitive;
+					}
+				});
+
+				if (reference.empty())
+				{
+					reference = primitives;
+					baseline = vector;
+				}
+
+				auto differing = 0u;
+				for (auto i = 0u; i < rays.size(); i++)
+				{
+					differing += reference[i] != primitives[i];
+				}
+
+				const auto error = static_cast<float>(differing) / rays.size();
+
+				::report("traversal", baseline, variant->name, vector, error);
+			}
+		}
+
+		// normalization, which goes through the refined reciprocal square root
+		{
+			std::vector<fx::vec3> vectors(size), reference(size), normalized(size);
+
+			for (auto& v : vectors)
+			{
+				v = { component(generator), component(generator), component(generator) };
+			}
+
+			const auto scalar = ::fastest([&]
+			{
+				for (auto i = 0u; i < size; i++)
+				{
+					reference[i] = fx::normalize(vectors[i]);
+				}
+			});
+
+			const auto vector = ::fastest([&]
+			{
+				for (auto i = 0u; i < size; i += simd::WIDTH)
+				{
+					const auto count = std::min(simd::WIDTH, size - i);
+					simd::store(&normalized[i], simd::normalize(simd::load(&vectors[i], count)), count);
+				}
+			});
+
+			auto error = 0.f;
+			for (auto i = 0u; i < size; i++)
+			{
+				error = std::max(error, ::difference(reference[i], normalized[i]));
+			}
+
+			::report("normalize", scalar, vector, error);
+		}
+
+		// path guiding against plain cosine sampling on the loaded scene, as the variance of the mean
+		// reached per unit of render time; the warmup frames are timed in both runs, so the guided run
+		// pays for the training iterations they cover
+		{
+			const auto saved = _options;
+
+			_options.width = 480;
+			_options.height = 270;
+			_options.mode = RenderMode::PATHTRACE;
+			_options.filter = Filter::NONE;
+			_options.irradiance = Irradiance::TRACE;
+			_options.samples = std::max(_options.samples, 1u);
+			_options.bounces = std::max(_options.bounces, 2u);
+			_options.paths = std::max(_options.paths, 1u);
+
+			_options.guiding = Guiding::OFF;
+			const auto cosine = ::converge(::WARMUP, ::FRAMES);
+
+			_options.guiding = Guiding::SDTREE;
+			const auto guided = ::converge(::WARMUP, ::FRAMES);
+
+			_options = saved;
+
+			// efficiency is one over variance times time, so the ratio of the products is the speedup
+			const auto speedup = (cosine.variance * cosine.milliseconds) / std::max(guided.variance * guided.milliseconds, 1e-30f);
+
+			log(std::format("path guiding     off variance {:.3e} in {:7.1f} ms  on variance {:.3e} in {:7.1f} ms  {:5.2f}x variance per time",
+				cosine.variance, cosine.milliseconds, guided.variance, guided.milliseconds, speedup));
+		}
+
+		// relative error of the reciprocal estimates over six decades
+		{
+			auto rsqrt_error = 0.f, rcp_error = 0.f;
+
+			for (auto i = 0u; i < (1u << 16); i += simd::WIDTH)
+			{
+				alignas(32) float in[simd::WIDTH], root[simd::WIDTH], reciprocal[simd::WIDTH];
+
+				for (auto lane = 0u; lane < simd::WIDTH; lane++)
+				{
+					in[lane] = std::pow(10.f, -3.f + 6.f * (i + lane) / (1u << 16));
+				}
+
+				simd::store(root, simd::rsqrt(simd::load(in)));
+				simd::store(reciprocal, simd::rcp(simd::load(in)));
+
+				for (auto lane = 0u; lane < simd::WIDTH; lane++)
+				{
+					rsqrt_error = std::max(rsqrt_error, std::abs(root[lane] * std::sqrt(in[lane]) - 1.f));
+					rcp_error = std::max(rcp_error, std::abs(reciprocal[lane] * in[lane] - 1.f));
+				}
+			}
+
+			log(std::format("rsqrt relative error {:.2e}, rcp relative error {:.2e}", rsqrt_error, rcp_error));
+		}
+
+		// lane masks packed to bits, against a scalar reference for every one of the 256 masks; traversal
+		// picks child slots by these bits, so any mismatch would send it to the wrong children
+		{
+			auto mismatches = 0u;
+
+			for (auto mask = 0u; mask < (1u << simd::WIDTH); mask++)
+			{
+				alignas(32) float lanes[simd::WIDTH];
+
+				for (auto lane = 0u; lane < simd::WIDTH; lane++)
+				{
+					lanes[lane] = (mask >> lane) & 1u ? 0.f : 1.f;
+				}
+
+				if (simd::bits(simd::less(simd::load(lanes), simd::broadcast(.5f))) != mask)
+				{
+					mismatches++;
+				}
+			}
+
+			if (mismatches != 0)
+			{
+				warning(std::format("{} of 256 lane masks packed incorrectly by the {} backend", mismatches, simd::backend()));
+			}
+
+			else
+			{
+				log(std::format("lane masks packed correctly by the {} backend", simd::backend()));
+			}
+		}
+	}
+}
@@ -0,0 +1,15 @@
+#ifndef LUMA_BENCHMARK_H
+#define LUMA_BENCHMARK_H
+
+// benchmark.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// times each simd kernel against the scalar code it replaced at 1080p, in every kernel variant the
+	// processor can run, and logs both along with the largest difference between their results; then
+	// compares path guiding on and off by the variance it reaches per unit of render time
+	void benchmark(void) noexcept;
+}
+
+#endif
@@ -0,0 +1,500 @@
+import std;
+
+#include "bvh.h"
+#include "kernels.h"
+
+// bvh.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	static constexpr auto BIN_COUNT = 16u;
+	static constexpr auto TRAVERSAL_COST = 1.f;
+
+	// beyond this depth the builder falls back to median splits, which bounds the traversal stack
+	static constexpr auto MAX_BINARY_DEPTH = 48u;
+
+	struct Bounds
+	{
+		std::array<float, 3> lo
+		{
+			std::numeric_limits<float>::max(),
+			std::numeric_limits<float>::max(),
+			std::numeric_limits<float>::max(),
+		};
+
+		std::array<float, 3> hi
+		{
+			std::numeric_limits<float>::lowest(),
+			std::numeric_limits<float>::lowest(),
+			std::numeric_limits<float>::lowest(),
+		};
+
+		void grow(const std::array<float, 3>& point) noexcept
+		{
+			for (auto axis = 0; axis < 3; axis++)
+			{
+				lo[axis] = std::min(lo[axis], point[axis]);
+				hi[axis] = std::max(hi[axis], point[axis]);
+			}
+		}
+
+		void grow(const Bounds& other) noexcept
+		{
+			grow(other.lo);
+			grow(other.hi);
+		}
+
+		float area(void) const noexcept
+		{
+			const auto dx = hi[0] - lo[0];
+			const auto dy = hi[1] - lo[1];
+			const auto dz = hi[2] - lo[2];
+
+			if (dx < 0 || dy < 0 || dz < 0)
+			{
+				return 0.f;
+			}
+
+			return 2 * (dx * dy + dy * dz + dz * dx);
+		}
+	};
+
+	struct BinaryNode
+	{
+		Bounds bounds;
+		std::uint32_t left, right;
+		// a non-zero count marks a leaf
+		std::uint32_t first, count;
+	};
+
+	class BinaryBuilder
+	{
+	private:
+		std::span<const luma::PackedSphere> _spheres;
+
+	public:
+		std::vector<BinaryNode> nodes;
+		std::vector<std::uint32_t> order;
+
+	private:
+		std::array<float, 3> center(std::uint32_t primitive) const noexcept
+		{
+			const auto& sphere = _spheres[primitive];
+			return { sphere.x, sphere.y, sphere.z };
+		}
+
+		Bounds box(std::uint32_t primitive) const noexcept
+		{
+			const auto& sphere = _spheres[primitive];
+			const auto r = sphere.radius;
+
+			Bounds out{};
+			out.lo = { sphere.x - r, sphere.y - r, sphere.z - r };
+			out.hi = { sphere.x + r, sphere.y + r, sphere.z + r };
+
+			return out;
+		}
+
+	public:
+		BinaryBuilder(std::span<const luma::PackedSphere> spheres) noexcept
+			: _spheres{ spheres }
+		{
+			order.resize(spheres.size());
+			std::iota(order.begin(), order.end(), 0u);
+
+			nodes.reserve(2 * spheres.size());
+		}
+
+	public:
+		std::uint32_t build(std::uint32_t first, std::uint32_t count, std::uint32_t depth) noexcept
+		{
+			const auto index = static_cast<std::uint32_t>(nodes.size());
+			nodes.emplace_back();
+
+			Bounds bounds{}, centroid_bounds{};
+
+			for (auto i = first; i < first + count; i++)
+			{
+				bounds.grow(box(order[i]));
+				centroid_bounds.grow(center(order[i]));
+			}
+
+			nodes[index].bounds = bounds;
+
+			if (count <= luma::BVH::LEAF_SIZE)
+			{
+				nodes[index].first = first;
+				nodes[index].count = count;
+				return index;
+			}
+
+			auto axis = 0;
+			for (auto i = 1; i < 3; i++)
+			{
+				if (centroid_bounds.hi[i] - centroid_bounds.lo[i] > centroid_bounds.hi[axis] - centroid_bounds.lo[axis])
+				{
+					axis = i;
+				}
+			}
+
+			const auto extent = centroid_bounds.hi[axis] - centroid_bounds.lo[axis];
+
+			auto split = first + count / 2;
+
+			if (extent > 0 && depth < MAX_BINARY_DEPTH)
+			{
+				split = split_sah(first, count, axis, centroid_bounds.lo[axis], extent, bounds.area());
+			}
+
+			else if (extent > 0)
+			{
+				const auto begin = order.begin() + first;
+				std::nth_element(begin, order.begin() + split, begin + count, [&](auto lhs, auto rhs)
+				{
+					return center(lhs)[axis] < center(rhs)[axis];
+				});
+			}
+
+			const auto left = build(first, split - first, depth + 1);
+			const auto right = build(split, first + count - split, depth + 1);
+
+			nodes[index].left = left;
+			nodes[index].right = right;
+			nodes[index].count = 0;
+
+			return index;
+		}
+
+	private:
+		std::uint32_t split_sah(std::uint32_t first, std::uint32_t count, int axis, float origin, float extent, float area) noexcept
+		{
+			struct Bin
+			{
+				Bounds bounds;
+				std::uint32_t count = 0;
+			};
+
+			std::array<Bin, BIN_COUNT> bins{};
+
+			const auto scale = BIN_COUNT / extent;
+
+			const auto bin_of = [&](std::uint32_t primitive)
+			{
+				const auto bin = static_cast<std::uint32_t>((center(primitive)[axis] - origin) * scale);
+				return std::min(bin, BIN_COUNT - 1);
+			};
+
+			for (auto i = first; i < first + count; i++)
+			{
+				auto& bin = bins[bin_of(order[i])];
+				bin.bounds.grow(box(order[i]));
+				bin.count++;
+			}
+
+			// sweep from the right to gather the cost of every candidate plane
+			std::array<float, BIN_COUNT - 1> right_area{};
+			std::array<std::uint32_t, BIN_COUNT - 1> right_count{};
+
+			Bounds accumulated{};
+			auto accumulated_count = 0u;
+
+			for (auto i = BIN_COUNT - 1; i > 0; i--)
+			{
+				accumulated.grow(bins[i].bounds);
+				accumulated_count += bins[i].count;
+
+				right_area[i - 1] = accumulated.area();
+				right_count[i - 1] = accumulated_count;
+			}
+
+			accumulated = {};
+			accumulated_count = 0;
+
+			auto best_cost = std::numeric_limits<float>::max();
+			auto best_plane = 0u;
+
+			for (auto i = 0u; i < BIN_COUNT - 1; i++)
+			{
+				accumulated.grow(bins[i].bounds);
+				accumulated_count += bins[i].count;
+
+				if (accumulated_count == 0 || right_count[i] == 0)
+				{
+					continue;
+				}
+
+				const auto cost = TRAVERSAL_COST * area + accumulated.area() * accumulated_count + right_area[i] * right_count[i];
+
+				if (cost < best_cost)
+				{
+					best_cost = cost;
+					best_plane = i;
+				}
+			}
+
+			const auto begin = order.begin() + first;
+			const auto middle = std::partition(begin, begin + count, [&](auto primitive)
+			{
+				return bin_of(primitive) <= best_plane;
+			});
+
+			const auto split = static_cast<std::uint32_t>(middle - order.begin());
+
+			// every centroid landed in a single bin, so fall back to splitting the range in half
+			if (split == first || split == first + count)
+			{
+				return first + count / 2;
+			}
+
+			return split;
+		}
+	};
+
+	class Collapser
+	{
+	private:
+		const BinaryBuilder& _builder;
+
+	public:
+		std::vector<luma::WideNode>& nodes;
+		std::vector<std::uint32_t>& order;
+
+	public:
+		Collapser(const BinaryBuilder& builder, std::vector<luma::WideNode>& nodes, std::vector<std::uint32_t>& order) noexcept
+			: _builder{ builder }, nodes{ nodes }, order{ order }
+		{
+		}
+
+	public:
+		void emit(std::uint32_t wide_index, std::uint32_t binary_index) noexcept
+		{
+			const auto& binary = _builder.nodes;
+			const auto& root = binary[binary_index];
+
+			std::array<std::uint32_t, luma::BVH::WIDTH> children{};
+			auto count = 0u;
+
+			if (root.count > 0)
+			{
+				children[count++] = binary_index;
+			}
+
+			else
+			{
+				children[count++] = root.left;
+				children[count++] = root.right;
+			}
+
+			// greedily open the largest internal child until all eight slots are in use
+			while (count < luma::BVH::WIDTH)
+			{
+				auto best = -1;
+				auto best_area = -1.f;
+
+				for (auto i = 0u; i < count; i++)
+				{
+					const auto& child = binary[children[i]];
+
+					if (child.count == 0 && child.bounds.area() > best_area)
+					{
+						best = static_cast<int>(i);
+						best_area = child.bounds.area();
+					}
+				}
+
+				if (best < 0)
+				{
+					break;
+				}
+
+				const auto& opened = binary[children[best]];
+				children[best] = opened.left;
+				children[count++] = opened.right;
+			}
+
+			luma::WideNode node{};
+
+			std::array<float, 3> inverse_scale{};
+
+			for (auto axis = 0; axis < 3; axis++)
+			{
+				const auto origin = root.bounds.lo[axis];
+				const auto extent = root.bounds.hi[axis] - origin;
+
+				auto exponent = extent > 0 ? static_cast<int>(std::ceil(std::log2(extent / 255.f))) : -126;
+				exponent = std::clamp(exponent, -126, 127);
+
+				// guard against log2 rounding down so the top child still fits in 8 bits
+				while (exponent < 127 && std::ldexp(255.f, exponent) < extent)
+				{
+					exponent++;
+				}
+
+				node.origin[axis] = origin;
+				node.exponent[axis] = static_cast<std::int8_t>(exponent);
+				inverse_scale[axis] = std::ldexp(1.f, -exponent);
+			}
+
+			node.child_base = static_cast<std::uint32_t>(nodes.size());
+			node.primitive_base = static_cast<std::uint32_t>(order.size());
+
+			std::array<std::uint32_t, luma::BVH::WIDTH> internal{};
+			auto internal_count = 0u;
+			auto primitive_offset = 0u;
+
+			for (auto slot = 0u; slot < luma::BVH::WIDTH; slot++)
+			{
+				if (slot >= count)
+				{
+					// an inverted box can never be entered
+					for (auto axis = 0; axis < 3; axis++)
+					{
+						node.lo[axis][slot] = 255;
+						node.hi[axis][slot] = 0;
+					}
+
+					continue;
+				}
+
+				const auto& child = binary[children[slot]];
+
+				// round outward so the quantized box is always conservative
+				for (auto axis = 0; axis < 3; axis++)
+				{
+					const auto lo = std::floor((child.bounds.lo[axis] - node.origin[axis]) * inverse_scale[axis]);
+					const auto hi = std::ceil((child.bounds.hi[axis] - node.origin[axis]) * inverse_scale[axis]);
+
+					node.lo[axis][slot] = static_cast<std::uint8_t>(std::clamp(lo, 0.f, 255.f));
+					node.hi[axis][slot] = static_cast<std::uint8_t>(std::clamp(hi, 0.f, 255.f));
+				}
+
+				if (child.count == 0)
+				{
+					node.internal_mask |= static_cast<std::uint8_t>(1u << slot);
+					internal[internal_count++] = children[slot];
+				}
+
+				else
+				{
+					node.meta[slot] = static_cast<std::uint8_t>((primitive_offset << 3) | child.count);
+
+					for (auto i = child.first; i < child.first + child.count; i++)
+					{
+						order.push_back(_builder.order[i]);
+					}
+
+					primitive_offset += child.count;
+				}
+			}
+
+			// reserve the contiguous block of internal children before descending
+			nodes.resize(nodes.size() + internal_count);
+			nodes[wide_index] = node;
+
+			for (auto i = 0u; i < internal_count; i++)
+			{
+				emit(node.child_base + i, internal[i]);
+			}
+		}
+	};
+}
+
+namespace luma
+{
+	std::vector<std::uint32_t> BVH::build(std::span<const PackedSphere> spheres) noexcept
+	{
+		_storage.clear();
+		_nodes = {};
+		_spheres = {};
+
+		std::vector<std::uint32_t> order{};
+
+		if (spheres.empty())
+		{
+			return order;
+		}
+
+		BinaryBuilder builder{ spheres };
+		const auto root = builder.build(0, static_cast<std::uint32_t>(spheres.size()), 0);
+
+		_storage.reserve(builder.nodes.size() / 4 + 1);
+		_storage.resize(1);
+		order.reserve(spheres.size());
+
+		Collapser collapser{ builder, _storage, order };
+		collapser.emit(0, root);
+
+		_storage.shrink_to_fit();
+		_nodes = _storage;
+
+		return order;
+	}
+
+	void BVH::attach(std::span<const PackedSphere> spheres) noexcept
+	{
+		_spheres = spheres;
+	}
+
+	void BVH::adopt(std::span<const WideNode> nodes, std::span<const PackedSphere> spheres) noexcept
+	{
+		_storage.clear();
+		_nodes = nodes;
+		_spheres = spheres;
+	}
+
+	bool BVH::valid(std::span<const WideNode> nodes, std::size_t sphere_count) noexcept
+	{
+		// the builder places children after their parents, so one forward pass reaches each parent first
+		std::vector<std::uint32_t> depth(nodes.size(), 0);
+
+		for (auto i = 0u; i < nodes.size(); i++)
+		{
+			const auto& node = nodes[i];
+			auto rank = 0u;
+
+			for (auto slot = 0u; slot < WIDTH; slot++)
+			{
+				if (node.internal_mask & (1u << slot))
+				{
+					const auto child = static_cast<std::uint64_t>(node.child_base) + rank++;
+
+					if (child <= i || child >= nodes.size())
+					{
+						return false;
+					}
+
+					depth[child] = std::max(depth[child], depth[i] + 1);
+
+					// each level down leaves at most its other siblings waiting on the stack
+					if (depth[child] * (WIDTH - 1) + WIDTH > STACK_SIZE)
+					{
+						return false;
+					}
+				}
+
+				else
+				{
+					const auto last = static_cast<std::uint64_t>(node.primitive_base) + (node.meta[slot] >> 3) + (node.meta[slot] & 0b111);
+
+					if (last > sphere_count)
+					{
+						return false;
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+	Hit BVH::intersect(const Ray& ray, float max) const noexcept
+	{
+		return kernels().intersect(_nodes, _spheres, ray, max);
+	}
+
+	bool BVH::occluded(const Ray& ray, float max) const noexcept
+	{
+		return kernels().occluded(_nodes, _spheres, ray, max);
+	}
+}
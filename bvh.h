@@ -0,0 +1,70 @@
+#ifndef LUMA_BVH_H
+#define LUMA_BVH_H
+
+#include "geometry.h"
+
+// bvh.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// collapsed 8-wide node; child boxes are stored as 8-bit offsets from the parent origin
+	// scaled per axis by a power of two, so one node covers all eight children in 80 bytes
+	struct alignas(16) WideNode
+	{
+		float origin[3];
+		std::int8_t exponent[3];
+		std::uint8_t internal_mask;
+
+		// internal children are stored contiguously starting at child_base
+		std::uint32_t child_base;
+		// leaf children reference primitives starting at primitive_base
+		std::uint32_t primitive_base;
+
+		// leaf children pack (offset << 3) | count
+		std::uint8_t meta[8];
+
+		std::uint8_t lo[3][8];
+		std::uint8_t hi[3][8];
+	};
+
+	static_assert(sizeof(WideNode) == 80);
+
+	class BVH
+	{
+	public:
+		static constexpr auto WIDTH = 8u;
+		static constexpr auto LEAF_SIZE = 4u;
+		// entries on the traversal stack; the builder's depth limit keeps trees well within it
+		static constexpr auto STACK_SIZE = 1024u;
+
+	private:
+		// owned nodes when built in memory; _nodes may instead view a mapped particle file
+		std::vector<WideNode> _storage;
+		std::span<const WideNode> _nodes;
+		// sphere geometry in traversal order, owned by the scene
+		std::span<const PackedSphere> _spheres;
+
+	public:
+		// builds the tree and returns the traversal order the spheres must be rearranged into before attach()
+		std::vector<std::uint32_t> build(std::span<const PackedSphere>) noexcept;
+		void attach(std::span<const PackedSphere>) noexcept;
+		// uses a prebuilt tree in place
+		void adopt(std::span<const WideNode>, std::span<const PackedSphere>) noexcept;
+
+		// whether a tree from outside the builder is safe to traverse over the given number of spheres:
+		// every child after its parent, every leaf within the spheres, and no path deeper than the stack holds
+		static bool valid(std::span<const WideNode>, std::size_t) noexcept;
+
+		// both queries run in whichever kernel variant select_kernels() picked
+		Hit intersect(const Ray&, float = std::numeric_limits<float>::max()) const noexcept;
+		// any-hit query for shadow and occlusion rays; stops at the first sphere within range
+		bool occluded(const Ray&, float = std::numeric_limits<float>::max()) const noexcept;
+
+	public:
+		std::size_t node_count(void) const noexcept { return _nodes.size(); }
+		std::span<const WideNode> nodes(void) const noexcept { return _nodes; }
+	};
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define LUMA_CAMERA_HPP
 
 #include "flux/types.h"
+#include "geometry.h"
 
 // camera.h
 // (c) 2025 Connor J. Link. All Rights Reserved.
@@ -13,14 +14,24 @@ namespace luma
 	public:
 		Camera(float, float, float, std::uint32_t, std::uint32_t) noexcept;
 		bool update(float, olc::PixelGameEngine*) noexcept;
+		void place(const fx::vec3&, float, float, float) noexcept;
+		// pixel coordinates a world-space point had in the previous frame
+		fx::vec2 reproject(const fx::vec3&) const noexcept;
+		// pixel coordinates of a world-space point in the current frame; false when it is behind the camera
+		bool project(const fx::vec3&, fx::vec2&) const noexcept;
+		// the current transforms in the form the ray generation kernel takes
+		RayBasis ray_basis(void) const noexcept;
 
 	private:
+		void recompute_direction(void) noexcept;
 		void recompute_projection(void) noexcept;
 		void recompute_view(void) noexcept;
 		void recompute_rays(void) noexcept;
 
 	public:
 		fx::mat4 projection, projection_inverse, view, view_inverse;
+		// matrices of the previous frame, used to derive motion vectors
+		fx::mat4 previous_projection, previous_view;
 
 		float fov = 70.0f;
 
@@ -0,0 +1,23 @@
+#ifndef LUMA_COLOR_H
+#define LUMA_COLOR_H
+
+#include "flux/types.h"
+
+// color.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// rec. 709 weights of each primary, also used by the vectorised kernels
+	static constexpr auto LUMINANCE_RED = .2126f;
+	static constexpr auto LUMINANCE_GREEN = .7152f;
+	static constexpr auto LUMINANCE_BLUE = .0722f;
+
+	// rec. 709 luminance of a linear colour, the brightness lights, paths and filters are compared by
+	inline float luminance(const fx::vec3& color) noexcept
+	{
+		return LUMINANCE_RED * color[0] + LUMINANCE_GREEN * color[1] + LUMINANCE_BLUE * color[2];
+	}
+}
+
+#endif
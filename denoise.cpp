@@ -0,0 +1,645 @@
+import std;
+
+#include "olcPixelGameEngine.h"
+
+#include "flux/vector.h"
+
+#include "denoise.h"
+#include "kernels.h"
+#include "color.h"
+
+// denoise.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	static constexpr auto COLOR_SIGMA = .5f;
+	static constexpr auto NORMAL_SIGMA = .3f;
+	static constexpr auto ALBEDO_SIGMA = .1f;
+	// relative to the centre depth
+	static constexpr auto DEPTH_SIGMA = .02f;
+}
+
+namespace
+{
+	// rows or pixels of a pass, as the index range its parallel loop runs over
+	std::vector<std::int32_t> indices(std::int32_t count) noexcept
+	{
+		std::vector<std::int32_t> out(count);
+		std::iota(out.begin(), out.end(), 0);
+
+		return out;
+	}
+}
+
+namespace
+{
+	// minimum blend weight of the new frame, so the history never stands in for more than ~9 frames
+	static constexpr auto COLOR_ALPHA = .2f;
+	static constexpr auto MOMENTS_ALPHA = .2f;
+
+	// below this history length the variance comes from a spatial estimate instead
+	static constexpr auto MIN_TEMPORAL_HISTORY = 4.f;
+	static constexpr auto VARIANCE_RADIUS = 3;
+
+	static constexpr auto LUMINANCE_SIGMA = 4.f;
+
+	// reprojected history further away in relative depth, or facing differently, is a disocclusion
+	static constexpr auto REPROJECT_DEPTH = .1f;
+	static constexpr auto REPROJECT_NORMAL = .9f;
+
+	float sharpen(float weight) noexcept
+	{
+		weight = std::max(weight, 0.f);
+
+		for (auto i = 0; i < luma::SVGF_NORMAL_SQUARINGS; i++)
+		{
+			weight *= weight;
+		}
+
+		return weight;
+	}
+}
+
+namespace luma
+{
+	void Features::reset(std::size_t size) noexcept
+	{
+		depth.assign(size, 0.f);
+		normal.assign(size, fx::vec3{});
+		albedo.assign(size, fx::vec3{});
+	}
+
+	void Denoiser::resize(std::uint32_t width, std::uint32_t height) noexcept
+	{
+		if (width == _width && height == _height)
+		{
+			return;
+		}
+
+		_width = width;
+		_height = height;
+
+		const auto size = static_cast<std::size_t>(width) * height;
+
+		for (auto k = 0u; k < 3; k++)
+		{
+			_color[k].resize(size);
+			_filtered[k].resize(size);
+			_normal[k].resize(size);
+			_albedo[k].resize(size);
+		}
+
+		_depth.resize(size);
+	}
+
+	void Denoiser::pass(std::uint32_t step, float color_weight) noexcept
+	{
+		const auto width = static_cast<std::int32_t>(_width);
+		const auto height = static_cast<std::int32_t>(_height);
+		const auto spacing = static_cast<std::int32_t>(step);
+		const auto reach = 2 * spacing;
+
+		const auto normal_weight = 1.f / (NORMAL_SIGMA * NORMAL_SIGMA);
+		const auto albedo_weight = 1.f / (ALBEDO_SIGMA * ALBEDO_SIGMA);
+		// wider taps are expected to land further away in depth
+		const auto depth_weight = 1.f / (DEPTH_SIGMA * static_cast<float>(step));
+
+		// raw plane pointers so the compiler need not reload them after every store
+		const float* const colors[3]{ _color[0].data(), _color[1].data(), _color[2].data() };
+		const float* const normals[3]{ _normal[0].data(), _normal[1].data(), _normal[2].data() };
+		const float* const albedos[3]{ _albedo[0].data(), _albedo[1].data(), _albedo[2].data() };
+		const float* const depths = _depth.data();
+		float* const filtered[3]{ _filtered[0].data(), _filtered[1].data(), _filtered[2].data() };
+
+		const auto filter = [&](std::int32_t x, std::int32_t y) noexcept
+		{
+			const auto p = y * width + x;
+
+			const auto inverse_depth = depth_weight / std::max(depths[p], FILTER_MIN_DEPTH);
+
+			float sum[3]{};
+			auto total = 0.f;
+
+			for (auto j = 0; j < 5; j++)
+			{
+				const auto row = std::clamp(y + (j - 2) * spacing, 0, height - 1) * width;
+
+				for (auto i = 0; i < 5; i++)
+				{
+					const auto q = row + std::clamp(x + (i - 2) * spacing, 0, width - 1);
+
+					auto color_distance = 0.f, normal_distance = 0.f, albedo_distance = 0.f;
+
+					for (auto k = 0; k < 3; k++)
+					{
+						const auto dc = colors[k][q] - colors[k][p];
+						const auto dn = normals[k][q] - normals[k][p];
+						const auto da = albedos[k][q] - albedos[k][p];
+
+						color_distance += dc * dc;
+						normal_distance += dn * dn;
+						albedo_distance += da * da;
+					}
+
+					const auto depth_distance = std::abs(depths[q] - depths[p]);
+
+					const auto exponent = color_distance * color_weight + normal_distance * normal_weight
+						+ albedo_distance * albedo_weight + depth_distance * inverse_depth;
+
+					const auto weight = WAVELET_TAPS[i] * WAVELET_TAPS[j] * std::exp(-std::min(exponent, FILTER_MAX_EXPONENT));
+
+					for (auto k = 0; k < 3; k++)
+					{
+						sum[k] += weight * colors[k][q];
+					}
+
+					total += weight;
+				}
+			}
+
+			// the centre tap always contributes, so total is never zero
+			for (auto k = 0; k < 3; k++)
+			{
+				filtered[k][p] = sum[k] / total;
+			}
+		};
+
+		const WaveletPass block
+		{
+			{ colors[0], colors[1], colors[2] },
+			{ normals[0], normals[1], normals[2] },
+			{ albedos[0], albedos[1], albedos[2] },
+			depths,
+			{ filtered[0], filtered[1], filtered[2] },
+			width, height, spacing,
+			color_weight, normal_weight, albedo_weight, depth_weight,
+		};
+
+		const auto& kernel = kernels();
+
+		const auto rows = ::indices(height);
+
+		std::for_each(std::execution::par, rows.begin(), rows.end(), [&](std::int32_t y)
+		{
+			auto x = 0;
+
+			for (; x < std::min(reach, width); x++)
+			{
+				filter(x, y);
+			}
+
+			// the kernel takes whole blocks of eight whose taps all stay inside the row
+			const auto blocks = std::max(width - 2 * reach, 0) / 8;
+
+			kernel.wavelet(block, y, x, x + 8 * blocks);
+			x += 8 * blocks;
+
+			for (; x < width; x++)
+			{
+				filter(x, y);
+			}
+		});
+
+		std::swap(_color, _filtered);
+	}
+
+	void Denoiser::apply(std::span<fx::vec3> color, const Features& features, float weight, std::uint32_t width, std::uint32_t height) noexcept
+	{
+		resize(width, height);
+
+		const auto size = static_cast<std::int32_t>(color.size());
+
+		const auto pixels = ::indices(size);
+
+		std::for_each(std::execution::par, pixels.begin(), pixels.end(), [&](std::int32_t i)
+		{
+			for (auto k = 0; k < 3; k++)
+			{
+				_color[k][i] = color[i][k];
+				_normal[k][i] = features.normal[i][k] * weight;
+				_albedo[k][i] = features.albedo[i][k] * weight;
+			}
+
+			_depth[i] = features.depth[i] * weight;
+		});
+
+		for (auto iteration = 0u; iteration < ITERATIONS; iteration++)
+		{
+			// the colour variance tolerance halves every pass as the remaining noise gets smoother
+			const auto color_weight = static_cast<float>(1u << iteration) / (COLOR_SIGMA * COLOR_SIGMA);
+			pass(1u << iteration, color_weight);
+		}
+
+		std::for_each(std::execution::par, pixels.begin(), pixels.end(), [&](std::int32_t i)
+		{
+			color[i] = { _color[0][i], _color[1][i], _color[2][i] };
+		});
+	}
+}
+
+namespace luma
+{
+	void Svgf::resize(std::uint32_t width, std::uint32_t height) noexcept
+	{
+		if (width == _width && height == _height)
+		{
+			return;
+		}
+
+		_width = width;
+		_height = height;
+
+		const auto size = static_cast<std::size_t>(width) * height;
+
+		_history_color.assign(size, fx::vec3{});
+		_history_moments.assign(size, fx::vec2{});
+		_history_length.assign(size, 0.f);
+		_history_depth.assign(size, 0.f);
+		_history_normal.assign(size, fx::vec3{});
+
+		_moments.resize(size);
+		_length.resize(size);
+
+		for (auto k = 0u; k < 3; k++)
+		{
+			_color[k].resize(size);
+			_filtered[k].resize(size);
+		}
+
+		for (auto& plane : _normal)
+		{
+			plane.resize(size);
+		}
+
+		for (auto& plane : _albedo)
+		{
+			plane.resize(size);
+		}
+
+		_luminance.resize(size);
+		_filtered_luminance.resize(size);
+		_variance.resize(size);
+		_filtered_variance.resize(size);
+		_blurred_variance.resize(size);
+		_depth.resize(size);
+	}
+
+	void Svgf::reset(void) noexcept
+	{
+		std::fill(_history_length.begin(), _history_length.end(), 0.f);
+	}
+
+	void Svgf::accumulate(std::span<const fx::vec3> color, const Features& features, const Camera& camera) noexcept
+	{
+		const auto width = static_cast<std::int32_t>(_width);
+		const auto height = static_cast<std::int32_t>(_height);
+
+		const auto rows = ::indices(height);
+
+		std::for_each(std::execution::par, rows.begin(), rows.end(), [&](std::int32_t y)
+		{
+			for (auto x = 0; x < width; x++)
+			{
+				const auto p = y * width + x;
+
+				const auto depth = features.depth[p];
+				const auto& normal = features.normal[p];
+				const auto sky = fx::dot(normal, normal) == 0.f;
+
+				// motion vector: where this pixel's first hit was on screen last frame
+				const auto world = fx::add(camera.pos, fx::scale(camera.rays[p], depth));
+				const auto previous = camera.reproject(world);
+
+				const auto px = std::floor(previous[0]);
+				const auto py = std::floor(previous[1]);
+				const auto tx = previous[0] - px;
+				const auto ty = previous[1] - py;
+
+				fx::vec3 history_color{};
+				fx::vec2 history_moments{};
+				auto history_length = 0.f;
+				auto total = 0.f;
+
+				// bilinear tap of the history that skips taps failing the consistency test
+				for (auto j = 0; j < 2; j++)
+				{
+					for (auto i = 0; i < 2; i++)
+					{
+						const auto qx = static_cast<std::int32_t>(px) + i;
+						const auto qy = static_cast<std::int32_t>(py) + j;
+
+						if (qx < 0 || qy < 0 || qx >= width || qy >= height)
+						{
+							continue;
+						}
+
+						const auto q = qy * width + qx;
+
+						const auto& history_normal = _history_normal[q];
+						const auto history_sky = fx::dot(history_normal, history_normal) == 0.f;
+
+						if (_history_length[q] == 0.f || sky != history_sky
+						 || std::abs(_history_depth[q] - depth) > REPROJECT_DEPTH * std::max(depth, FILTER_MIN_DEPTH)
+						 || (!sky && fx::dot(normal, history_normal) < REPROJECT_NORMAL))
+						{
+							continue;
+						}
+
+						const auto weight = (i ? tx : 1 - tx) * (j ? ty : 1 - ty);
+
+						history_color = fx::add(history_color, fx::scale(_history_color[q], weight));
+						history_moments = fx::add(history_moments, fx::scale(_history_moments[q], weight));
+						history_length += _history_length[q] * weight;
+						total += weight;
+					}
+				}
+
+				const auto& sample = color[p];
+				const auto lum = luminance(sample);
+				const fx::vec2 moments{ lum, lum * lum };
+
+				if (total > 1e-4f)
+				{
+					const auto inverse = 1 / total;
+
+					history_color = fx::scale(history_color, inverse);
+					history_moments = fx::scale(history_moments, inverse);
+					history_length = std::min(history_length * inverse + 1.f, MAX_HISTORY);
+				}
+
+				// disoccluded, so start over from this frame alone
+				else
+				{
+					history_color = sample;
+					history_moments = moments;
+					history_length = 1.f;
+				}
+
+				const auto color_alpha = std::max(1.f / history_length, COLOR_ALPHA);
+				const auto moments_alpha = std::max(1.f / history_length, MOMENTS_ALPHA);
+
+				const auto blended = fx::add(fx::scale(history_color, 1 - color_alpha), fx::scale(sample, color_alpha));
+
+				_moments[p] = fx::add(fx::scale(history_moments, 1 - moments_alpha), fx::scale(moments, moments_alpha));
+				_length[p] = history_length;
+
+				for (auto k = 0; k < 3; k++)
+				{
+					_color[k][p] = blended[k];
+					_normal[k][p] = normal[k];
+					_albedo[k][p] = features.albedo[p][k];
+				}
+
+				_normal[3][p] = sky ? 1.f : 0.f;
+				_depth[p] = depth;
+				_luminance[p] = luminance(blended);
+				_variance[p] = std::max(0.f, _moments[p][1] - _moments[p][0] * _moments[p][0]);
+			}
+		});
+	}
+
+	void Svgf::estimate_variance(void) noexcept
+	{
+		const auto width = static_cast<std::int32_t>(_width);
+		const auto height = static_cast<std::int32_t>(_height);
+
+		const auto rows = ::indices(height);
+
+		std::for_each(std::execution::par, rows.begin(), rows.end(), [&](std::int32_t y)
+		{
+			for (auto x = 0; x < width; x++)
+			{
+				const auto p = y * width + x;
+
+				if (_length[p] >= MIN_TEMPORAL_HISTORY)
+				{
+					_filtered_variance[p] = _variance[p];
+					continue;
+				}
+
+				// too few frames for temporal moments, so borrow them from similar neighbours
+				fx::vec2 moments{};
+				auto total = 0.f;
+
+				for (auto j = -VARIANCE_RADIUS; j <= VARIANCE_RADIUS; j++)
+				{
+					const auto qy = std::clamp(y + j, 0, height - 1);
+
+					for (auto i = -VARIANCE_RADIUS; i <= VARIANCE_RADIUS; i++)
+					{
+						const auto q = qy * width + std::clamp(x + i, 0, width - 1);
+
+						auto facing = 0.f, albedo_distance = 0.f;
+
+						for (auto k = 0; k < 4; k++)
+						{
+							facing += _normal[k][p] * _normal[k][q];
+						}
+
+						for (auto k = 0; k < 3; k++)
+						{
+							const auto da = _albedo[k][q] - _albedo[k][p];
+							albedo_distance += da * da;
+						}
+
+						const auto distance = static_cast<float>(std::max(std::abs(i), std::abs(j)));
+						const auto exponent = std::abs(_depth[p] - _depth[q]) / (DEPTH_SIGMA * std::max(_depth[p], FILTER_MIN_DEPTH) * (distance + 1))
+							+ albedo_distance / (ALBEDO_SIGMA * ALBEDO_SIGMA);
+
+						const auto weight = ::sharpen(facing) * std::exp(-std::min(exponent, FILTER_MAX_EXPONENT));
+
+						moments = fx::add(moments, fx::scale(_moments[q], weight));
+						total += weight;
+					}
+				}
+
+				moments = fx::scale(moments, 1 / std::max(total, 1e-6f));
+
+				// a spatial estimate on young history is unreliable, so err on the side of filtering more
+				const auto boost = MIN_TEMPORAL_HISTORY / _length[p];
+				_filtered_variance[p] = std::max(0.f, moments[1] - moments[0] * moments[0]) * boost;
+			}
+		});
+
+		std::swap(_variance, _filtered_variance);
+	}
+
+	void Svgf::pass(std::uint32_t step) noexcept
+	{
+		const auto width = static_cast<std::int32_t>(_width);
+		const auto height = static_cast<std::int32_t>(_height);
+		const auto spacing = static_cast<std::int32_t>(step);
+
+		const auto depth_weight = 1.f / (DEPTH_SIGMA * static_cast<float>(step));
+		// albedo stands in for the texture demodulation of the original, keeping material edges sharp
+		const auto albedo_weight = 1.f / (ALBEDO_SIGMA * ALBEDO_SIGMA);
+
+		// the variance of a single pixel is itself noisy, so the luminance tolerance uses a 3x3 blur of it
+		const auto rows = ::indices(height);
+
+		std::for_each(std::execution::par, rows.begin(), rows.end(), [&](std::int32_t y)
+		{
+			for (auto x = 0; x < width; x++)
+			{
+				auto variance = 0.f;
+
+				for (auto j = 0; j < 3; j++)
+				{
+					const auto row = std::clamp(y + j - 1, 0, height - 1) * width;
+
+					for (auto i = 0; i < 3; i++)
+					{
+						variance += SVGF_TAPS[i] * SVGF_TAPS[j] * _variance[row + std::clamp(x + i - 1, 0, width - 1)];
+					}
+				}
+
+				_blurred_variance[y * width + x] = 1.f / (LUMINANCE_SIGMA * std::sqrt(variance) + 1e-6f);
+			}
+		});
+
+		const float* const colors[3]{ _color[0].data(), _color[1].data(), _color[2].data() };
+		const float* const normals[4]{ _normal[0].data(), _normal[1].data(), _normal[2].data(), _normal[3].data() };
+		const float* const albedos[3]{ _albedo[0].data(), _albedo[1].data(), _albedo[2].data() };
+		const float* const luminances = _luminance.data();
+		const float* const variances = _variance.data();
+		const float* const luminance_scales = _blurred_variance.data();
+		const float* const depths = _depth.data();
+
+		float* const filtered[3]{ _filtered[0].data(), _filtered[1].data(), _filtered[2].data() };
+		float* const filtered_luminances = _filtered_luminance.data();
+		float* const filtered_variances = _filtered_variance.data();
+
+		const auto filter = [&](std::int32_t x, std::int32_t y) noexcept
+		{
+			const auto p = y * width + x;
+
+			const auto inverse_depth = depth_weight / std::max(depths[p], FILTER_MIN_DEPTH);
+
+			float sum[3]{};
+			auto sum_variance = 0.f, total = 0.f;
+
+			for (auto j = 0; j < 3; j++)
+			{
+				const auto row = std::clamp(y + (j - 1) * spacing, 0, height - 1) * width;
+
+				for (auto i = 0; i < 3; i++)
+				{
+					const auto q = row + std::clamp(x + (i - 1) * spacing, 0, width - 1);
+
+					auto facing = 0.f, albedo_distance = 0.f;
+
+					for (auto k = 0; k < 4; k++)
+					{
+						facing += normals[k][p] * normals[k][q];
+					}
+
+					for (auto k = 0; k < 3; k++)
+					{
+						const auto da = albedos[k][q] - albedos[k][p];
+						albedo_distance += da * da;
+					}
+
+					const auto exponent = std::abs(luminances[p] - luminances[q]) * luminance_scales[p]
+						+ std::abs(depths[p] - depths[q]) * inverse_depth + albedo_distance * albedo_weight;
+
+					const auto weight = SVGF_TAPS[i] * SVGF_TAPS[j] * ::sharpen(facing) * std::exp(-std::min(exponent, FILTER_MAX_EXPONENT));
+
+					for (auto k = 0; k < 3; k++)
+					{
+						sum[k] += weight * colors[k][q];
+					}
+
+					sum_variance += weight * weight * variances[q];
+					total += weight;
+				}
+			}
+
+			// the centre tap always has full weight, so total is never zero
+			const auto inverse_total = 1.f / total;
+
+			for (auto k = 0; k < 3; k++)
+			{
+				filtered[k][p] = sum[k] * inverse_total;
+			}
+
+			filtered_luminances[p] = luminance({ filtered[0][p], filtered[1][p], filtered[2][p] });
+			filtered_variances[p] = sum_variance * inverse_total * inverse_total;
+		};
+
+		const SvgfPass block
+		{
+			{ colors[0], colors[1], colors[2] },
+			{ normals[0], normals[1], normals[2], normals[3] },
+			{ albedos[0], albedos[1], albedos[2] },
+			luminances, variances, luminance_scales, depths,
+			{ filtered[0], filtered[1], filtered[2] },
+			filtered_luminances, filtered_variances,
+			width, height, spacing,
+			albedo_weight, depth_weight,
+		};
+
+		const auto& kernel = kernels();
+
+		std::for_each(std::execution::par, rows.begin(), rows.end(), [&](std::int32_t y)
+		{
+			auto x = 0;
+
+			for (; x < std::min(spacing, width); x++)
+			{
+				filter(x, y);
+			}
+
+			const auto blocks = std::max(width - 2 * spacing, 0) / 8;
+
+			kernel.svgf(block, y, x, x + 8 * blocks);
+			x += 8 * blocks;
+
+			for (; x < width; x++)
+			{
+				filter(x, y);
+			}
+		});
+
+		std::swap(_color, _filtered);
+		std::swap(_luminance, _filtered_luminance);
+		std::swap(_variance, _filtered_variance);
+	}
+
+	void Svgf::apply(std::span<const fx::vec3> color, const Features& features, const Camera& camera, std::span<fx::vec3> out) noexcept
+	{
+		resize(camera.width, camera.height);
+
+		accumulate(color, features, camera);
+		estimate_variance();
+
+		// the integrated moments carry over to the next frame unfiltered
+		std::swap(_history_moments, _moments);
+		std::swap(_history_length, _length);
+
+		const auto size = static_cast<std::int32_t>(out.size());
+		const auto pixels = ::indices(size);
+
+		for (auto iteration = 0u; iteration < ITERATIONS; iteration++)
+		{
+			pass(1u << iteration);
+
+			// the history keeps the lightly filtered colour, so later frames start less noisy without being blurred repeatedly
+			if (iteration == 0)
+			{
+				std::for_each(std::execution::par, pixels.begin(), pixels.end(), [&](std::int32_t i)
+				{
+					_history_color[i] = { _color[0][i], _color[1][i], _color[2][i] };
+				});
+			}
+		}
+
+		_history_depth = features.depth;
+		_history_normal = features.normal;
+
+		std::for_each(std::execution::par, pixels.begin(), pixels.end(), [&](std::int32_t i)
+		{
+			out[i] = { _color[0][i], _color[1][i], _color[2][i] };
+		});
+	}
+}
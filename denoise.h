@@ -0,0 +1,136 @@
+#ifndef LUMA_DENOISE_H
+#define LUMA_DENOISE_H
+
+#include "flux/types.h"
+#include "camera.h"
+
+// denoise.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// first-hit auxiliary buffers, accumulated alongside the colour
+	struct Features
+	{
+		std::vector<float> depth;
+		std::vector<fx::vec3> normal, albedo;
+
+		void reset(std::size_t) noexcept;
+	};
+
+	// b3-spline taps of the denoiser's 5x5 kernel; svgf runs every interactive frame, so it uses the
+	// cheaper 3x3 binomial instead
+	static constexpr float WAVELET_TAPS[5]{ 1.f / 16, 1.f / 4, 3.f / 8, 1.f / 4, 1.f / 16 };
+	static constexpr float SVGF_TAPS[3]{ 1.f / 4, 1.f / 2, 1.f / 4 };
+
+	// depths are clamped to this before anything is divided by them
+	static constexpr auto FILTER_MIN_DEPTH = 1e-3f;
+	// weights below e^-64 are clamped there; anything smaller only produces slow denormals
+	static constexpr auto FILTER_MAX_EXPONENT = 64.f;
+	// svgf's normal weights are raised to the 2^SVGF_NORMAL_SQUARINGS = 128th power
+	static constexpr auto SVGF_NORMAL_SQUARINGS = 7;
+
+	// one a-trous pass over planar buffers, as the filters hand it to the vectorized kernels
+	struct WaveletPass
+	{
+		const float* colors[3];
+		const float* normals[3];
+		const float* albedos[3];
+		const float* depths;
+		float* filtered[3];
+
+		std::int32_t width, height, spacing;
+		float color_weight, normal_weight, albedo_weight, depth_weight;
+	};
+
+	// svgf additionally carries luminance and its variance through every pass
+	struct SvgfPass
+	{
+		const float* colors[3];
+		// xyz plus the sky flag
+		const float* normals[4];
+		const float* albedos[3];
+		const float* luminances;
+		const float* variances;
+		// per-pixel luminance tolerance from the blurred variance
+		const float* luminance_scales;
+		const float* depths;
+		float* filtered[3];
+		float* filtered_luminances;
+		float* filtered_variances;
+
+		std::int32_t width, height, spacing;
+		float albedo_weight, depth_weight;
+	};
+
+	// edge-avoiding a-trous wavelet filter (dammertz et al. 2010); each pass widens the 5x5
+	// b3-spline kernel by spacing its taps further apart and weights every tap by how closely
+	// its colour, normal, albedo and depth match the centre pixel
+	class Denoiser
+	{
+	public:
+		static constexpr auto ITERATIONS = 5u;
+
+	private:
+		std::uint32_t _width = 0, _height = 0;
+
+		// planar copies so that eight horizontally adjacent pixels load as one vector
+		std::array<std::vector<float>, 3> _color, _filtered;
+		std::array<std::vector<float>, 3> _normal, _albedo;
+		std::vector<float> _depth;
+
+	private:
+		void resize(std::uint32_t, std::uint32_t) noexcept;
+		void pass(std::uint32_t step, float color_weight) noexcept;
+
+	public:
+		// filters a mean colour buffer in place; feature sums are scaled by the given weight first
+		void apply(std::span<fx::vec3>, const Features&, float, std::uint32_t, std::uint32_t) noexcept;
+	};
+
+	// spatiotemporal variance-guided filtering (schied et al. 2017) for 1 spp interactive frames:
+	// each frame is blended with the reprojected history, luminance variance is tracked through
+	// per-pixel moments, and an a-trous filter whose luminance tolerance follows that variance
+	// removes whatever noise the history has not absorbed yet
+	class Svgf
+	{
+	public:
+		static constexpr auto ITERATIONS = 5u;
+		// caps the effective number of frames blended into the history
+		static constexpr auto MAX_HISTORY = 32.f;
+
+	private:
+		std::uint32_t _width = 0, _height = 0;
+
+		// state carried over from the previous frame
+		std::vector<fx::vec3> _history_color;
+		std::vector<fx::vec2> _history_moments;
+		std::vector<float> _history_length, _history_depth;
+		std::vector<fx::vec3> _history_normal;
+
+		std::vector<fx::vec2> _moments;
+		std::vector<float> _length;
+
+		// planar working set for the wavelet passes
+		std::array<std::vector<float>, 3> _color, _filtered;
+		std::vector<float> _luminance, _filtered_luminance;
+		std::vector<float> _variance, _filtered_variance, _blurred_variance;
+		// xyz plus a flag that is one for sky pixels, so that sky only ever matches sky
+		std::array<std::vector<float>, 4> _normal;
+		std::array<std::vector<float>, 3> _albedo;
+		std::vector<float> _depth;
+
+	private:
+		void resize(std::uint32_t, std::uint32_t) noexcept;
+		void accumulate(std::span<const fx::vec3>, const Features&, const Camera&) noexcept;
+		void estimate_variance(void) noexcept;
+		void pass(std::uint32_t) noexcept;
+
+	public:
+		// filters one frame of single-sample colour; the features must hold this frame's first hits only
+		void apply(std::span<const fx::vec3>, const Features&, const Camera&, std::span<fx::vec3>) noexcept;
+		void reset(void) noexcept;
+	};
+}
+
+#endif
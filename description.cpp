@@ -0,0 +1,302 @@
+import std;
+
+#include "description.h"
+#include "mapping.h"
+#include "log.h"
+
+// description.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	// single-pass tokenizer over the mapped file; tokens are views into the mapping so nothing is copied
+	class Reader
+	{
+	private:
+		const char* _at;
+		const char* _end;
+		std::uint32_t _line = 1;
+
+	public:
+		Reader(const char* begin, const char* end) noexcept
+			: _at{ begin }, _end{ end }
+		{
+		}
+
+	public:
+		// skips blanks and comments; false once the current line has nothing left
+		bool more(void) noexcept
+		{
+			while (_at < _end && (*_at == ' ' || *_at == '\t' || *_at == '\r'))
+			{
+				_at++;
+			}
+
+			if (_at < _end && *_at == '#')
+			{
+				_at = std::find(_at, _end, '\n');
+			}
+
+			return _at < _end && *_at != '\n';
+		}
+
+		bool next_line(void) noexcept
+		{
+			_at = std::find(_at, _end, '\n');
+
+			if (_at == _end)
+			{
+				return false;
+			}
+
+			_at++;
+			_line++;
+
+			return true;
+		}
+
+		std::string_view token(void) noexcept
+		{
+			if (!more())
+			{
+				return {};
+			}
+
+			const auto start = _at;
+
+			while (_at < _end && *_at != ' ' && *_at != '\t' && *_at != '\r' && *_at != '\n' && *_at != '#')
+			{
+				_at++;
+			}
+
+			return { start, static_cast<std::size_t>(_at - start) };
+		}
+
+		template<typename T>
+		bool number(T& out) noexcept
+		{
+			const auto text = token();
+
+			if (text.empty())
+			{
+				return false;
+			}
+
+			const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+			return ec == std::errc() && ptr == text.data() + text.size();
+		}
+
+		bool vector(fx::vec3& out) noexcept
+		{
+			return number(out[0]) && number(out[1]) && number(out[2]);
+		}
+
+	public:
+		std::uint32_t line(void) const noexcept
+		{
+			return _line;
+		}
+	};
+}
+
+namespace luma
+{
+	SceneDescription _description;
+
+	bool load_scene(const std::string& filepath, SceneDescription& description, Options& options) noexcept
+	{
+		MappedFile file{};
+
+		if (!file.open(filepath))
+		{
+			log(std::format("error opening scene file `{}`", filepath));
+			return false;
+		}
+
+		const auto begin = reinterpret_cast<const char*>(file.data());
+		const auto end = begin + file.size();
+
+		description = {};
+
+		// one sphere per line is the common case, so size the arrays once up front
+		const auto lines = static_cast<std::size_t>(std::count(begin, end, '\n')) + 1;
+		description.spheres.reserve(lines);
+		description.material_ids.reserve(lines);
+
+		std::unordered_map<std::string_view, std::uint16_t> names{};
+
+		// render settings are parsed into a copy and only applied once the whole file has been read
+		auto settings = options;
+
+		Reader reader{ begin, end };
+
+		const auto fail = [&](std::string_view reason)
+		{
+			log(std::format("error in scene file `{}` on line {}: {}", filepath, reader.line(), reason));
+			description = {};
+			return false;
+		};
+
+		do
+		{
+			if (!reader.more())
+			{
+				continue;
+			}
+
+			const auto keyword = reader.token();
+
+			if (keyword == "sphere")
+			{
+				fx::vec3 pos{};
+				auto radius = 0.f;
+
+				if (!reader.vector(pos) || !reader.number(radius))
+				{
+					return fail("expected `sphere <x> <y> <z> <radius> <material>`");
+				}
+
+				if (!(radius > 0.f))
+				{
+					return fail("sphere radius must be positive");
+				}
+
+				const auto name = reader.token();
+				const auto material = names.find(name);
+
+				if (material == names.end())
+				{
+					return fail(std::format("undeclared material `{}`", name));
+				}
+
+				description.spheres.push_back({ pos[0], pos[1], pos[2], radius });
+				description.material_ids.push_back(material->second);
+			}
+
+			else if (keyword == "material")
+			{
+				const auto name = reader.token();
+
+				if (name.empty())
+				{
+					return fail("expected a material name");
+				}
+
+				if (description.materials.size() > std::numeric_limits<std::uint16_t>::max())
+				{
+					return fail("too many materials");
+				}
+
+				Material material{ { 1.f, 1.f, 1.f }, 1.f, 0.f, 0.f };
+
+				while (reader.more())
+				{
+					const auto key = reader.token();
+
+					auto success = false;
+
+					     if (key == "diffuse") { success = reader.vector(material.diffuse); }
+					else if (key == "albedo") { success = reader.number(material.albedo); }
+					else if (key == "metallic") { success = reader.number(material.metallic); }
+					else if (key == "roughness") { success = reader.number(material.roughness); }
+					else if (key == "emission") { success = reader.vector(material.emission); }
+
+					if (!success)
+					{
+						return fail(std::format("invalid material property `{}`", key));
+					}
+				}
+
+				names[name] = static_cast<std::uint16_t>(description.materials.size());
+				description.materials.push_back(material);
+			}
+
+			else if (keyword == "light")
+			{
+				fx::vec3 dir{};
+
+				if (!reader.vector(dir))
+				{
+					return fail("expected `light <x> <y> <z>`");
+				}
+
+				description.light = dir;
+			}
+
+			else if (keyword == "camera")
+			{
+				while (reader.more())
+				{
+					const auto key = reader.token();
+
+					auto success = false;
+
+					if (key == "pos")
+					{
+						fx::vec3 pos{};
+						success = reader.vector(pos);
+						description.camera_pos = pos;
+					}
+
+					else if (key == "yaw" || key == "pitch" || key == "fov")
+					{
+						auto value = 0.f;
+						success = reader.number(value);
+
+						auto& target = key == "yaw" ? description.camera_yaw : key == "pitch" ? description.camera_pitch : description.camera_fov;
+						target = value;
+					}
+
+					if (!success)
+					{
+						return fail(std::format("invalid camera property `{}`", key));
+					}
+				}
+			}
+
+			else if (keyword == "render")
+			{
+				while (reader.more())
+				{
+					const auto key = reader.token();
+
+					auto success = false;
+
+					     if (key == "width") { success = reader.number(settings.width); }
+					else if (key == "height") { success = reader.number(settings.height); }
+					else if (key == "samples") { success = reader.number(settings.samples); }
+					else if (key == "bounces") { success = reader.number(settings.bounces); }
+					else if (key == "paths") { success = reader.number(settings.paths); }
+					else if (key == "mode")
+					{
+						const auto mode = std::string{ reader.token() };
+						success = _render_mode_map.contains(mode);
+
+						if (success)
+						{
+							settings.mode = _render_mode_map.at(mode);
+						}
+					}
+
+					if (!success)
+					{
+						return fail(std::format("invalid render setting `{}`", key));
+					}
+				}
+			}
+
+			else
+			{
+				return fail(std::format("unrecognized statement `{}`", keyword));
+			}
+
+			if (reader.more())
+			{
+				return fail(std::format("unexpected `{}`", reader.token()));
+			}
+		} while (reader.next_line());
+
+		options = settings;
+		return true;
+	}
+}
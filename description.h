@@ -0,0 +1,41 @@
+#ifndef LUMA_DESCRIPTION_H
+#define LUMA_DESCRIPTION_H
+
+#include "flux/types.h"
+#include "geometry.h"
+#include "arguments.h"
+
+// description.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// contents of a text scene file; one statement per line, `#` starts a comment
+	//
+	//   material <name> diffuse <r> <g> <b> [albedo <a>] [metallic <m>] [roughness <r>] [emission <r> <g> <b>]
+	//   sphere <x> <y> <z> <radius> <material>
+	//   light <x> <y> <z>
+	//   camera [pos <x> <y> <z>] [yaw <radians>] [pitch <radians>] [fov <degrees>]
+	//   render [width <w>] [height <h>] [samples <n>] [bounces <n>] [paths <n>] [mode <mode>]
+	//
+	// materials must be declared before the spheres that use them
+	struct SceneDescription
+	{
+		std::vector<Material> materials;
+		std::vector<PackedSphere> spheres;
+		std::vector<std::uint16_t> material_ids;
+
+		std::optional<fx::vec3> light;
+
+		std::optional<fx::vec3> camera_pos;
+		std::optional<float> camera_yaw, camera_pitch, camera_fov;
+	};
+
+	// render settings in the file are applied to the options as soon as it loads, so later command-line options
+	// still override them; a file that fails to parse leaves the description empty and the options as they were
+	bool load_scene(const std::string&, SceneDescription&, Options&) noexcept;
+
+	extern SceneDescription _description;
+}
+
+#endif
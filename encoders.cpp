@@ -0,0 +1,879 @@
+import std;
+
+#include "encoders.h"
+
+// encoders.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	void put_be32(std::uint8_t* out, std::uint32_t value) noexcept
+	{
+		out[0] = static_cast<std::uint8_t>(value >> 24);
+		out[1] = static_cast<std::uint8_t>(value >> 16);
+		out[2] = static_cast<std::uint8_t>(value >> 8);
+		out[3] = static_cast<std::uint8_t>(value);
+	}
+
+	void append_be32(std::vector<std::uint8_t>& out, std::uint32_t value) noexcept
+	{
+		out.resize(out.size() + 4);
+		::put_be32(out.data() + out.size() - 4, value);
+	}
+
+	// qoi
+
+	constexpr std::uint8_t QOI_OP_INDEX = 0x00;
+	constexpr std::uint8_t QOI_OP_DIFF = 0x40;
+	constexpr std::uint8_t QOI_OP_LUMA = 0x80;
+	constexpr std::uint8_t QOI_OP_RUN = 0xC0;
+	constexpr std::uint8_t QOI_OP_RGB = 0xFE;
+
+	constexpr auto QOI_HEADER_SIZE = 14u;
+	constexpr std::array<std::uint8_t, 8> QOI_END{ 0, 0, 0, 0, 0, 0, 0, 1 };
+
+	// png
+
+	// pixels per stripe: enough data for the matcher to find its runs, while 1080p still splits eight ways
+	constexpr auto STRIPE = 1u << 18;
+	// symbols per deflate block, each of which gets huffman codes fitted to its own statistics
+	constexpr auto BLOCK_TOKENS = 1u << 16;
+
+	constexpr auto HASH_BITS = 15u;
+	constexpr auto WINDOW = 32768u;
+	constexpr auto MIN_MATCH = 4u;
+	constexpr auto MAX_MATCH = 258u;
+
+	constexpr auto LITLEN_CODES = 286u;
+	constexpr auto DISTANCE_CODES = 30u;
+	constexpr auto LENGTH_CODES = 19u;
+	constexpr auto END_OF_BLOCK = 256u;
+
+	// order in which the code length code lengths are stored (rfc 1951 3.2.7)
+	constexpr std::array<std::uint8_t, LENGTH_CODES> LENGTH_ORDER{ 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	constexpr auto MATCH_FLAG = 1u << 31;
+
+	// a literal byte, or a match packed as flag | (length - 3) << 16 | distance
+	using Token = std::uint32_t;
+
+	struct Symbol
+	{
+		std::uint32_t code, extra_bits, extra;
+	};
+
+	Symbol length_symbol(std::uint32_t length) noexcept
+	{
+		const auto value = length - 3;
+
+		if (value < 8)
+		{
+			return { 257 + value, 0, 0 };
+		}
+
+		if (length == MAX_MATCH)
+		{
+			return { 285, 0, 0 };
+		}
+
+		const auto magnitude = static_cast<std::uint32_t>(std::bit_width(value)) - 1;
+		const auto extra_bits = magnitude - 2;
+
+		return { 257 + 4 * (magnitude - 1) + ((value >> extra_bits) & 3), extra_bits, value & ((1u << extra_bits) - 1) };
+	}
+
+	Symbol distance_symbol(std::uint32_t distance) noexcept
+	{
+		const auto value = distance - 1;
+
+		if (value < 4)
+		{
+			return { value, 0, 0 };
+		}
+
+		const auto magnitude = static_cast<std::uint32_t>(std::bit_width(value)) - 1;
+		const auto extra_bits = magnitude - 1;
+
+		return { 2 * magnitude + ((value >> extra_bits) & 1), extra_bits, value & ((1u << extra_bits) - 1) };
+	}
+
+	// deflate writes bits from the least significant end, which leaves huffman codes reversed
+	std::uint32_t reverse_bits(std::uint32_t code, std::uint32_t length) noexcept
+	{
+		auto out = 0u;
+
+		for (auto i = 0u; i < length; i++)
+		{
+			out = (out << 1) | ((code >> i) & 1);
+		}
+
+		return out;
+	}
+
+	// code lengths no longer than the limit; lengths are found on a huffman tree and then shortened
+	// as zlib and miniz do, by trading the deepest codes against splitting shallower ones
+	void build_lengths(const std::uint32_t* frequencies, std::uint32_t count, std::uint32_t limit, std::uint8_t* lengths) noexcept
+	{
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> used;
+
+		for (auto i = 0u; i < count; i++)
+		{
+			lengths[i] = 0;
+
+			if (frequencies[i] != 0)
+			{
+				used.emplace_back(frequencies[i], i);
+			}
+		}
+
+		// a complete code needs two symbols; decoders reject a lone one-bit code in some trees
+		for (auto i = 0u; used.size() < 2; i++)
+		{
+			if (frequencies[i] == 0)
+			{
+				used.emplace_back(1, i);
+			}
+		}
+
+		std::sort(used.begin(), used.end());
+
+		const auto leaves = static_cast<std::uint32_t>(used.size());
+
+		// leaves arrive sorted and merged nodes are made in order, so two queues replace a heap
+		std::vector<std::uint64_t> weight(2 * leaves - 1);
+		std::vector<std::uint32_t> parent(2 * leaves - 1), depth(2 * leaves - 1);
+
+		for (auto i = 0u; i < leaves; i++)
+		{
+			weight[i] = used[i].first;
+		}
+
+		auto leaf = 0u, node = leaves;
+
+		for (auto next = leaves; next < 2 * leaves - 1; next++)
+		{
+			auto take = [&]
+			{
+				return leaf < leaves && (node >= next || weight[leaf] <= weight[node]) ? leaf++ : node++;
+			};
+
+			const auto a = take();
+			const auto b = take();
+
+			weight[next] = weight[a] + weight[b];
+			parent[a] = next;
+			parent[b] = next;
+		}
+
+		std::array<std::uint32_t, 16> per_length{};
+
+		for (auto i = 2 * leaves - 1; i-- > 0;)
+		{
+			depth[i] = i == 2 * leaves - 2 ? 0 : depth[parent[i]] + 1;
+
+			if (i < leaves)
+			{
+				per_length[std::min(depth[i], limit)]++;
+			}
+		}
+
+		auto total = 0u;
+
+		for (auto length = 1u; length <= limit; length++)
+		{
+			total += per_length[length] << (limit - length);
+		}
+
+		while (total != (1u << limit))
+		{
+			per_length[limit]--;
+
+			for (auto length = limit - 1; length > 0; length--)
+			{
+				if (per_length[length] != 0)
+				{
+					per_length[length]--;
+					per_length[length + 1] += 2;
+					break;
+				}
+			}
+
+			total--;
+		}
+
+		// the rarest symbols take the longest codes
+		auto next = 0u;
+
+		for (auto length = limit; length > 0; length--)
+		{
+			for (auto i = 0u; i < per_length[length]; i++)
+			{
+				lengths[used[next++].second] = static_cast<std::uint8_t>(length);
+			}
+		}
+	}
+
+	// canonical codes for the given lengths, already reversed for the bit writer
+	void build_codes(const std::uint8_t* lengths, std::uint32_t count, std::uint32_t* codes) noexcept
+	{
+		std::array<std::uint32_t, 16> per_length{}, next{};
+
+		for (auto i = 0u; i < count; i++)
+		{
+			per_length[lengths[i]]++;
+		}
+
+		per_length[0] = 0;
+
+		for (auto length = 1u, code = 0u; length < 16; length++)
+		{
+			code = (code + per_length[length - 1]) << 1;
+			next[length] = code;
+		}
+
+		for (auto i = 0u; i < count; i++)
+		{
+			codes[i] = lengths[i] != 0 ? ::reverse_bits(next[lengths[i]]++, lengths[i]) : 0;
+		}
+	}
+
+	class BitWriter
+	{
+	private:
+		std::vector<std::uint8_t>& _out;
+		std::uint64_t _bits = 0;
+		std::uint32_t _count = 0;
+
+	public:
+		explicit BitWriter(std::vector<std::uint8_t>& out) noexcept
+			: _out{ out }
+		{
+		}
+
+	public:
+		// up to 32 bits at a time
+		void put(std::uint32_t value, std::uint32_t bits) noexcept
+		{
+			_bits |= static_cast<std::uint64_t>(value) << _count;
+			_count += bits;
+
+			if (_count >= 32)
+			{
+				for (auto i = 0; i < 4; i++)
+				{
+					_out.push_back(static_cast<std::uint8_t>(_bits));
+					_bits >>= 8;
+				}
+
+				_count -= 32;
+			}
+		}
+
+		// pads to the next byte boundary with zeros
+		void align(void) noexcept
+		{
+			for (; _count > 0; _count = _count > 8 ? _count - 8 : 0)
+			{
+				_out.push_back(static_cast<std::uint8_t>(_bits));
+				_bits >>= 8;
+			}
+
+			_bits = 0;
+		}
+	};
+
+	// one block with dynamic huffman codes (rfc 1951 3.2.7)
+	void write_block(::BitWriter& writer, const std::vector<::Token>& tokens, bool last) noexcept
+	{
+		std::array<std::uint32_t, LITLEN_CODES> litlen_frequencies{};
+		std::array<std::uint32_t, DISTANCE_CODES> distance_frequencies{};
+
+		for (const auto token : tokens)
+		{
+			if (token & MATCH_FLAG)
+			{
+				litlen_frequencies[::length_symbol(((token >> 16) & 0xFF) + 3).code]++;
+				distance_frequencies[::distance_symbol(token & 0xFFFF).code]++;
+			}
+
+			else
+			{
+				litlen_frequencies[token]++;
+			}
+		}
+
+		litlen_frequencies[END_OF_BLOCK]++;
+
+		std::array<std::uint8_t, LITLEN_CODES + DISTANCE_CODES> lengths{};
+		const auto litlen_lengths = lengths.data();
+		const auto distance_lengths = lengths.data() + LITLEN_CODES;
+
+		::build_lengths(litlen_frequencies.data(), LITLEN_CODES, 15, litlen_lengths);
+		::build_lengths(distance_frequencies.data(), DISTANCE_CODES, 15, distance_lengths);
+
+		auto litlen_count = LITLEN_CODES;
+		while (litlen_count > 257 && litlen_lengths[litlen_count - 1] == 0) litlen_count--;
+
+		auto distance_count = DISTANCE_CODES;
+		while (distance_count > 1 && distance_lengths[distance_count - 1] == 0) distance_count--;
+
+		// both tables' lengths run together, with repeats and runs of zeros coded as 16, 17 and 18
+		std::array<std::uint8_t, LITLEN_CODES + DISTANCE_CODES> sequence{};
+		std::copy_n(litlen_lengths, litlen_count, sequence.begin());
+		std::copy_n(distance_lengths, distance_count, sequence.begin() + litlen_count);
+
+		const auto sequence_count = litlen_count + distance_count;
+
+		std::vector<std::pair<std::uint8_t, std::uint8_t>> runs;
+		std::array<std::uint32_t, LENGTH_CODES> length_frequencies{};
+
+		auto emit = [&](std::uint8_t symbol, std::uint8_t extra)
+		{
+			runs.emplace_back(symbol, extra);
+			length_frequencies[symbol]++;
+		};
+
+		for (auto i = 0u; i < sequence_count;)
+		{
+			const auto value = sequence[i];
+
+			auto end = i;
+			while (end < sequence_count && sequence[end] == value) end++;
+
+			auto run = end - i;
+
+			if (value == 0)
+			{
+				for (; run >= 11; run -= std::min(run, 138u))
+				{
+					emit(18, static_cast<std::uint8_t>(std::min(run, 138u) - 11));
+				}
+
+				if (run >= 3)
+				{
+					emit(17, static_cast<std::uint8_t>(run - 3));
+					run = 0;
+				}
+			}
+
+			else
+			{
+				emit(value, 0);
+				run--;
+
+				for (; run >= 3; run -= std::min(run, 6u))
+				{
+					emit(16, static_cast<std::uint8_t>(std::min(run, 6u) - 3));
+				}
+			}
+
+			for (; run > 0; run--)
+			{
+				emit(value, 0);
+			}
+
+			i = end;
+		}
+
+		std::array<std::uint8_t, LENGTH_CODES> length_lengths{};
+		std::array<std::uint32_t, LENGTH_CODES> length_codes{};
+
+		::build_lengths(length_frequencies.data(), LENGTH_CODES, 7, length_lengths.data());
+		::build_codes(length_lengths.data(), LENGTH_CODES, length_codes.data());
+
+		auto length_count = LENGTH_CODES;
+		while (length_count > 4 && length_lengths[LENGTH_ORDER[length_count - 1]] == 0) length_count--;
+
+		std::array<std::uint32_t, LITLEN_CODES> litlen_codes{};
+		std::array<std::uint32_t, DISTANCE_CODES> distance_codes{};
+
+		::build_codes(litlen_lengths, LITLEN_CODES, litlen_codes.data());
+		::build_codes(distance_lengths, DISTANCE_CODES, distance_codes.data());
+
+		writer.put(last ? 1 : 0, 1);
+		writer.put(2, 2);
+		writer.put(litlen_count - 257, 5);
+		writer.put(distance_count - 1, 5);
+		writer.put(length_count - 4, 4);
+
+		for (auto i = 0u; i < length_count; i++)
+		{
+			writer.put(length_lengths[LENGTH_ORDER[i]], 3);
+		}
+
+		for (const auto& [symbol, extra] : runs)
+		{
+			writer.put(length_codes[symbol], length_lengths[symbol]);
+
+			switch (symbol)
+			{
+				case 16: writer.put(extra, 2); break;
+				case 17: writer.put(extra, 3); break;
+				case 18: writer.put(extra, 7); break;
+			}
+		}
+
+		for (const auto token : tokens)
+		{
+			if (token & MATCH_FLAG)
+			{
+				const auto length = ::length_symbol(((token >> 16) & 0xFF) + 3);
+				const auto distance = ::distance_symbol(token & 0xFFFF);
+
+				writer.put(litlen_codes[length.code], litlen_lengths[length.code]);
+				writer.put(length.extra, length.extra_bits);
+				writer.put(distance_codes[distance.code], distance_lengths[distance.code]);
+				writer.put(distance.extra, distance.extra_bits);
+			}
+
+			else
+			{
+				writer.put(litlen_codes[token], litlen_lengths[token]);
+			}
+		}
+
+		writer.put(litlen_codes[END_OF_BLOCK], litlen_lengths[END_OF_BLOCK]);
+	}
+
+	// greedy lz77 against a single hash candidate, which finds the long runs filtered renders are made of
+	// without chasing the short matches in their noise
+	void deflate(const std::uint8_t* data, std::uint32_t size, bool last, std::vector<std::uint8_t>& out) noexcept
+	{
+		std::vector<std::int32_t> head(1u << HASH_BITS, -1);
+		std::vector<::Token> tokens;
+		tokens.reserve(BLOCK_TOKENS);
+
+		::BitWriter writer{ out };
+
+		auto load = [&](std::uint32_t at)
+		{
+			std::uint32_t value;
+			std::memcpy(&value, data + at, sizeof(value));
+			return value;
+		};
+
+		for (auto at = 0u; at < size;)
+		{
+			auto length = 0u;
+			auto distance = 0u;
+
+			if (at + MIN_MATCH <= size)
+			{
+				const auto value = load(at);
+				const auto hash = (value * 2654435761u) >> (32 - HASH_BITS);
+				const auto candidate = head[hash];
+				head[hash] = static_cast<std::int32_t>(at);
+
+				if (candidate >= 0 && at - candidate <= WINDOW && load(candidate) == value)
+				{
+					const auto limit = std::min(MAX_MATCH, size - at);
+
+					length = MIN_MATCH;
+					while (length < limit && data[candidate + length] == data[at + length]) length++;
+
+					distance = at - candidate;
+				}
+			}
+
+			if (length != 0)
+			{
+				tokens.push_back(MATCH_FLAG | ((length - 3) << 16) | distance);
+				at += length;
+			}
+
+			else
+			{
+				tokens.push_back(data[at]);
+				at++;
+			}
+
+			if (tokens.size() == BLOCK_TOKENS)
+			{
+				::write_block(writer, tokens, false);
+				tokens.clear();
+			}
+		}
+
+		::write_block(writer, tokens, last);
+
+		if (!last)
+		{
+			// an empty stored block brings the stream back to a byte boundary, where the next stripe's
+			// blocks can follow directly
+			writer.put(0, 3);
+			writer.align();
+
+			out.insert(out.end(), { 0x00, 0x00, 0xFF, 0xFF });
+		}
+
+		else
+		{
+			writer.align();
+		}
+	}
+
+	constexpr auto ADLER_MODULUS = 65521u;
+
+	std::uint32_t adler32(const std::uint8_t* data, std::size_t size) noexcept
+	{
+		std::uint32_t a = 1, b = 0;
+
+		// the largest run of bytes after which b cannot yet overflow
+		constexpr auto RUN = std::size_t{ 5552 };
+
+		for (std::size_t begin = 0; begin < size; begin += RUN)
+		{
+			const auto end = std::min(size, begin + RUN);
+
+			for (auto i = begin; i < end; i++)
+			{
+				a += data[i];
+				b += a;
+			}
+
+			a %= ADLER_MODULUS;
+			b %= ADLER_MODULUS;
+		}
+
+		return (b << 16) | a;
+	}
+
+	// checksum of two spans joined, from each span's checksum and the second's length
+	std::uint32_t adler32_combine(std::uint32_t first, std::uint32_t second, std::size_t size) noexcept
+	{
+		const auto remainder = static_cast<std::uint64_t>(size % ADLER_MODULUS);
+
+		const auto first_a = static_cast<std::uint64_t>(first & 0xFFFF), first_b = static_cast<std::uint64_t>(first >> 16);
+		const auto second_a = static_cast<std::uint64_t>(second & 0xFFFF), second_b = static_cast<std::uint64_t>(second >> 16);
+
+		const auto a = (first_a + second_a + ADLER_MODULUS - 1) % ADLER_MODULUS;
+		const auto b = (remainder * first_a + first_b + second_b + ADLER_MODULUS - remainder) % ADLER_MODULUS;
+
+		return static_cast<std::uint32_t>((b << 16) | a);
+	}
+
+	const std::array<std::uint32_t, 256>& crc_table(void) noexcept
+	{
+		static const auto table = []
+		{
+			std::array<std::uint32_t, 256> out{};
+
+			for (auto i = 0u; i < 256; i++)
+			{
+				auto crc = i;
+
+				for (auto bit = 0; bit < 8; bit++)
+				{
+					crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+				}
+
+				out[i] = crc;
+			}
+
+			return out;
+		}();
+
+		return table;
+	}
+
+	// running crc-32 without the final inversion, so that it can be carried on over more data
+	std::uint32_t crc32_update(std::uint32_t crc, const std::uint8_t* data, std::size_t size) noexcept
+	{
+		const auto& table = ::crc_table();
+
+		for (std::size_t i = 0; i < size; i++)
+		{
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+
+		return crc;
+	}
+
+	void append_chunk(std::vector<std::uint8_t>& out, const char* type, const std::uint8_t* data, std::size_t size) noexcept
+	{
+		::append_be32(out, static_cast<std::uint32_t>(size));
+
+		const auto start = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data, data + size);
+
+		::append_be32(out, ~::crc32_update(0xFFFFFFFFu, out.data() + start, size + 4));
+	}
+
+	std::uint8_t paeth(std::int32_t a, std::int32_t b, std::int32_t c) noexcept
+	{
+		const auto p = a + b - c;
+		const auto pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+
+		return static_cast<std::uint8_t>(pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+	}
+
+	// residuals of one row under a png filter type; a and c are zero left of the first pixel
+	void filter_row(std::uint8_t type, const std::uint8_t* row, const std::uint8_t* above, std::uint32_t size, std::uint8_t* out) noexcept
+	{
+		constexpr auto BPP = 3u;
+
+		for (auto i = 0u; i < size; i++)
+		{
+			const std::int32_t a = i >= BPP ? row[i - BPP] : 0;
+			const std::int32_t b = above[i];
+			const std::int32_t c = i >= BPP ? above[i - BPP] : 0;
+
+			std::int32_t prediction = 0;
+
+			switch (type)
+			{
+				case 1: prediction = a; break;
+				case 2: prediction = b; break;
+				case 3: prediction = (a + b) / 2; break;
+				case 4: prediction = ::paeth(a, b, c); break;
+			}
+
+			out[i] = static_cast<std::uint8_t>(row[i] - prediction);
+		}
+	}
+
+	void unpack_row(const std::uint32_t* pixels, std::int32_t width, std::uint8_t* out) noexcept
+	{
+		for (auto x = 0; x < width; x++)
+		{
+			const auto pixel = pixels[x];
+
+			out[3 * x + 0] = static_cast<std::uint8_t>(pixel >> 16);
+			out[3 * x + 1] = static_cast<std::uint8_t>(pixel >> 8);
+			out[3 * x + 2] = static_cast<std::uint8_t>(pixel);
+		}
+	}
+
+	struct Stripe
+	{
+		std::vector<std::uint8_t> deflated;
+		std::uint32_t adler = 1;
+		std::size_t filtered_size = 0;
+		// running crc of the idat chunk's type and data
+		std::uint32_t crc = 0;
+	};
+}
+
+namespace luma
+{
+	std::vector<std::uint8_t> encode_qoi(const std::uint32_t* pixels, std::int32_t width, std::int32_t height) noexcept
+	{
+		const auto count = static_cast<std::size_t>(width) * height;
+
+		// every pixel at worst as a four-byte rgb op
+		std::vector<std::uint8_t> out(QOI_HEADER_SIZE + 4 * count + QOI_END.size());
+		auto cursor = out.data();
+
+		std::memcpy(cursor, "qoif", 4);
+		::put_be32(cursor + 4, static_cast<std::uint32_t>(width));
+		::put_be32(cursor + 8, static_cast<std::uint32_t>(height));
+		// three channels, srgb with linear alpha
+		cursor[12] = 3;
+		cursor[13] = 0;
+		cursor += QOI_HEADER_SIZE;
+
+		// pixels are stored as 0x00RRGGBB, with the alpha of 255 that qoi assumes left implicit
+		// nothing is seen yet, and no pixel matches the all-ones sentinel
+		std::array<std::uint32_t, 64> seen{};
+		seen.fill(~0u);
+		auto previous = 0u;
+		auto run = 0u;
+
+		for (std::size_t i = 0; i < count; i++)
+		{
+			const auto pixel = pixels[i] & 0xFFFFFF;
+
+			if (pixel == previous)
+			{
+				if (++run == 62 || i + 1 == count)
+				{
+					*cursor++ = static_cast<std::uint8_t>(QOI_OP_RUN | (run - 1));
+					run = 0;
+				}
+
+				continue;
+			}
+
+			if (run > 0)
+			{
+				*cursor++ = static_cast<std::uint8_t>(QOI_OP_RUN | (run - 1));
+				run = 0;
+			}
+
+			const auto r = static_cast<std::uint8_t>(pixel >> 16);
+			const auto g = static_cast<std::uint8_t>(pixel >> 8);
+			const auto b = static_cast<std::uint8_t>(pixel);
+
+			const auto hash = (r * 3 + g * 5 + b * 7 + 255 * 11) % 64;
+
+			if (seen[hash] == pixel)
+			{
+				*cursor++ = static_cast<std::uint8_t>(QOI_OP_INDEX | hash);
+			}
+
+			else
+			{
+				seen[hash] = pixel;
+
+				// channel differences wrap around like the bytes they are
+				const auto dr = static_cast<std::int8_t>(r - static_cast<std::uint8_t>(previous >> 16));
+				const auto dg = static_cast<std::int8_t>(g - static_cast<std::uint8_t>(previous >> 8));
+				const auto db = static_cast<std::int8_t>(b - static_cast<std::uint8_t>(previous));
+
+				const auto dr_dg = dr - dg;
+				const auto db_dg = db - dg;
+
+				if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+				{
+					*cursor++ = static_cast<std::uint8_t>(QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+				}
+
+				else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7)
+				{
+					*cursor++ = static_cast<std::uint8_t>(QOI_OP_LUMA | (dg + 32));
+					*cursor++ = static_cast<std::uint8_t>((dr_dg + 8) << 4 | (db_dg + 8));
+				}
+
+				else
+				{
+					*cursor++ = QOI_OP_RGB;
+					*cursor++ = r;
+					*cursor++ = g;
+					*cursor++ = b;
+				}
+			}
+
+			previous = pixel;
+		}
+
+		cursor = std::copy(QOI_END.begin(), QOI_END.end(), cursor);
+
+		out.resize(static_cast<std::size_t>(cursor - out.data()));
+		return out;
+	}
+
+	std::vector<std::uint8_t> encode_png(const std::uint32_t* pixels, std::int32_t width, std::int32_t height) noexcept
+	{
+		const auto row_size = 3u * width;
+		const auto rows_per_stripe = std::max(1u, STRIPE / static_cast<std::uint32_t>(std::max(width, 1)));
+		const auto stripe_count = (static_cast<std::uint32_t>(height) + rows_per_stripe - 1) / rows_per_stripe;
+
+		std::vector<::Stripe> stripes(stripe_count);
+		std::vector<std::uint32_t> indices(stripe_count);
+		std::iota(indices.begin(), indices.end(), 0u);
+
+		std::for_each(std::execution::par, indices.begin(), indices.end(), [&](std::uint32_t index)
+		{
+			auto& stripe = stripes[index];
+
+			const auto begin = static_cast<std::int32_t>(index * rows_per_stripe);
+			const auto end = std::min(height, begin + static_cast<std::int32_t>(rows_per_stripe));
+
+			// every row starts with its filter type; filters look at the row above even across stripes
+			std::vector<std::uint8_t> filtered(static_cast<std::size_t>(end - begin) * (row_size + 1));
+			std::vector<std::uint8_t> above(row_size), row(row_size), candidate(row_size);
+
+			if (begin > 0)
+			{
+				::unpack_row(pixels + static_cast<std::size_t>(begin - 1) * width, width, above.data());
+			}
+
+			for (auto y = begin; y < end; y++)
+			{
+				::unpack_row(pixels + static_cast<std::size_t>(y) * width, width, row.data());
+
+				const auto out = filtered.data() + static_cast<std::size_t>(y - begin) * (row_size + 1);
+
+				// the usual heuristic: the filter whose residuals, read as signed bytes, sum smallest
+				auto best = std::numeric_limits<std::uint64_t>::max();
+
+				for (std::uint8_t type = 0; type < 5; type++)
+				{
+					::filter_row(type, row.data(), above.data(), row_size, candidate.data());
+
+					auto cost = std::uint64_t{ 0 };
+
+					for (const auto residual : candidate)
+					{
+						cost += static_cast<std::uint64_t>(std::abs(static_cast<std::int8_t>(residual)));
+					}
+
+					if (cost < best)
+					{
+						best = cost;
+						out[0] = type;
+						std::copy(candidate.begin(), candidate.end(), out + 1);
+					}
+				}
+
+				std::swap(above, row);
+			}
+
+			stripe.filtered_size = filtered.size();
+			stripe.adler = ::adler32(filtered.data(), filtered.size());
+
+			stripe.deflated.reserve(filtered.size() / 2);
+
+			// zlib header: deflate with a 32 KiB window and no preset dictionary
+			if (index == 0)
+			{
+				stripe.deflated.insert(stripe.deflated.end(), { 0x78, 0x01 });
+			}
+
+			::deflate(filtered.data(), static_cast<std::uint32_t>(filtered.size()), index + 1 == stripe_count, stripe.deflated);
+
+			stripe.crc = ::crc32_update(0xFFFFFFFFu, reinterpret_cast<const std::uint8_t*>("IDAT"), 4);
+			stripe.crc = ::crc32_update(stripe.crc, stripe.deflated.data(), stripe.deflated.size());
+		});
+
+		// the zlib stream closes on the checksum of all the filtered data
+		auto adler = 1u;
+
+		for (const auto& stripe : stripes)
+		{
+			adler = ::adler32_combine(adler, stripe.adler, stripe.filtered_size);
+		}
+
+		std::uint8_t trailer[4]{};
+		::put_be32(trailer, adler);
+
+		auto& last = stripes.back();
+		last.deflated.insert(last.deflated.end(), trailer, trailer + 4);
+		last.crc = ::crc32_update(last.crc, trailer, 4);
+
+		auto total = std::size_t{ 64 };
+
+		for (const auto& stripe : stripes)
+		{
+			total += stripe.deflated.size() + 12;
+		}
+
+		std::vector<std::uint8_t> out;
+		out.reserve(total);
+
+		out.insert(out.end(), { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' });
+
+		// 8-bit truecolor, deflate, adaptive filtering, no interlacing
+		std::uint8_t header[13]{};
+		::put_be32(header, static_cast<std::uint32_t>(width));
+		::put_be32(header + 4, static_cast<std::uint32_t>(height));
+		header[8] = 8;
+		header[9] = 2;
+
+		::append_chunk(out, "IHDR", header, sizeof(header));
+
+		// one idat chunk per stripe; together they hold the single zlib stream
+		for (const auto& stripe : stripes)
+		{
+			::append_be32(out, static_cast<std::uint32_t>(stripe.deflated.size()));
+			out.insert(out.end(), { 'I', 'D', 'A', 'T' });
+			out.insert(out.end(), stripe.deflated.begin(), stripe.deflated.end());
+			::append_be32(out, ~stripe.crc);
+		}
+
+		::append_chunk(out, "IEND", nullptr, 0);
+
+		return out;
+	}
+}
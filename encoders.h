@@ -0,0 +1,19 @@
+#ifndef LUMA_ENCODERS_H
+#define LUMA_ENCODERS_H
+
+// encoders.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// both take 0x00RRGGBB pixels, top row first, and return the whole file
+
+	// quite ok image format: one serial pass of run, index and delta codes, lossless and very fast
+	std::vector<std::uint8_t> encode_qoi(const std::uint32_t*, std::int32_t, std::int32_t) noexcept;
+
+	// rgb png whose rows are filtered and deflated in independent stripes on every core; each stripe
+	// ends on a byte boundary, so the compressed stripes simply follow one another in the idat chunks
+	std::vector<std::uint8_t> encode_png(const std::uint32_t*, std::int32_t, std::int32_t) noexcept;
+}
+
+#endif
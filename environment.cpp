@@ -0,0 +1,329 @@
+import std;
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_NO_STDIO
+#include "stb_image.h"
+
+#include "flux/timer.h"
+#include "flux/vector.h"
+#include "environment.h"
+#include "mapping.h"
+#include "log.h"
+#include "color.h"
+#include "sampler.h"
+
+// environment.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	// vose's construction; zero-weight distributions fall back to uniform
+	void build_alias(std::span<const float> weights, std::span<luma::AliasEntry> table) noexcept
+	{
+		const auto count = weights.size();
+
+		auto total = 0.;
+		for (const auto weight : weights)
+		{
+			total += weight;
+		}
+
+		if (total <= 0.)
+		{
+			for (auto i = 0u; i < count; i++)
+			{
+				table[i] = { 1.f, i };
+			}
+
+			return;
+		}
+
+		std::vector<double> scaled(count);
+		std::vector<std::uint32_t> small, large;
+
+		for (auto i = 0u; i < count; i++)
+		{
+			scaled[i] = weights[i] * count / total;
+			(scaled[i] < 1. ? small : large).push_back(i);
+		}
+
+		while (!small.empty() && !large.empty())
+		{
+			const auto lesser = small.back();
+			small.pop_back();
+
+			const auto greater = large.back();
+
+			table[lesser] = { static_cast<float>(scaled[lesser]), greater };
+
+			// the greater slot donates whatever the lesser one lacks
+			scaled[greater] -= 1. - scaled[lesser];
+
+			if (scaled[greater] < 1.)
+			{
+				large.pop_back();
+				small.push_back(greater);
+			}
+		}
+
+		// leftovers are only off from one by rounding
+		for (const auto i : small)
+		{
+			table[i] = { 1.f, i };
+		}
+
+		for (const auto i : large)
+		{
+			table[i] = { 1.f, i };
+		}
+	}
+
+	// picks a slot and returns the position within it, so the same sample can place the point inside the texel
+	std::uint32_t pick(std::span<const luma::AliasEntry> table, float u, float& remainder) noexcept
+	{
+		const auto scaled = u * table.size();
+		const auto slot = std::min(static_cast<std::uint32_t>(scaled), static_cast<std::uint32_t>(table.size() - 1));
+		const auto fraction = scaled - slot;
+
+		const auto& entry = table[slot];
+
+		if (fraction < entry.probability)
+		{
+			remainder = std::min(fraction / entry.probability, luma::ONE_MINUS_EPSILON);
+			return slot;
+		}
+
+		remainder = std::min((fraction - entry.probability) / (1.f - entry.probability), luma::ONE_MINUS_EPSILON);
+		return entry.alias;
+	}
+
+	std::string table_path(const std::string& filepath) noexcept
+	{
+		return filepath + ".alias";
+	}
+
+	// texel a direction falls into, along with the sine of its polar angle
+	std::uint32_t texel(const fx::vec3& dir, std::uint32_t width, std::uint32_t height, float& sin_theta) noexcept
+	{
+		const auto theta = std::acos(std::clamp(-dir[1], -1.f, 1.f));
+		auto phi = std::atan2(dir[2], dir[0]);
+
+		if (phi < 0.f)
+		{
+			phi += 2.f * fx::pi();
+		}
+
+		const auto x = std::min(static_cast<std::uint32_t>(phi / (2.f * fx::pi()) * width), width - 1);
+		const auto y = std::min(static_cast<std::uint32_t>(theta / fx::pi() * height), height - 1);
+
+		sin_theta = std::sin(theta);
+		return y * width + x;
+	}
+
+	// converts a texel probability to a density over the solid angle, as each texel covers 2 pi^2 sin(theta) / (width * height)
+	float solid_angle_pdf(float probability, std::uint32_t width, std::uint32_t height, float sin_theta) noexcept
+	{
+		return sin_theta > 0.f ? probability * width * height / (2.f * fx::pi() * fx::pi() * sin_theta) : 0.f;
+	}
+}
+
+namespace luma
+{
+	void Environment::build_tables(void) noexcept
+	{
+		const auto size = static_cast<std::size_t>(_width) * _height;
+
+		_pdf.resize(size);
+		_rows.resize(_height);
+		_columns.resize(size);
+
+		std::vector<float> row_weights(_height);
+		auto total = 0.;
+
+		for (auto y = 0u; y < _height; y++)
+		{
+			// rows near the poles cover less of the sphere
+			const auto sin_theta = std::sin(fx::pi() * (y + .5f) / _height);
+
+			auto row_total = 0.f;
+
+			for (auto x = 0u; x < _width; x++)
+			{
+				const auto index = y * _width + x;
+				const auto weight = luminance(_texels[index]) * sin_theta;
+
+				_pdf[index] = weight;
+				row_total += weight;
+			}
+
+			row_weights[y] = row_total;
+			total += row_total;
+
+			::build_alias({ _pdf.data() + y * _width, _width }, { _columns.data() + y * _width, _width });
+		}
+
+		::build_alias(row_weights, _rows);
+
+		// a black map is sampled uniformly over its texels, matching the uniform alias tables
+		for (auto& pdf : _pdf)
+		{
+			pdf = total > 0. ? static_cast<float>(pdf / total) : 1.f / size;
+		}
+	}
+
+	bool Environment::load_tables(const std::string& filepath, std::uint64_t source_size, std::int64_t source_time) noexcept
+	{
+		MappedFile file{};
+
+		if (!file.open(filepath))
+		{
+			return false;
+		}
+
+		const auto size = static_cast<std::size_t>(_width) * _height;
+		const auto expected = sizeof(EnvironmentHeader) + size * sizeof(float) + (_height + size) * sizeof(AliasEntry);
+
+		if (file.size() != expected)
+		{
+			return false;
+		}
+
+		EnvironmentHeader header{};
+		std::memcpy(&header, file.data(), sizeof(header));
+
+		if (std::memcmp(header.magic, TABLE_MAGIC, sizeof(TABLE_MAGIC)) != 0 || header.version != TABLE_VERSION
+		 || header.width != _width || header.height != _height
+		 || header.source_size != source_size || header.source_time != source_time)
+		{
+			return false;
+		}
+
+		_pdf.resize(size);
+		_rows.resize(_height);
+		_columns.resize(size);
+
+		auto offset = sizeof(EnvironmentHeader);
+
+		const auto read = [&](void* bytes, std::size_t count)
+		{
+			std::memcpy(bytes, file.data() + offset, count);
+			offset += count;
+		};
+
+		read(_pdf.data(), size * sizeof(float));
+		read(_rows.data(), _height * sizeof(AliasEntry));
+		read(_columns.data(), size * sizeof(AliasEntry));
+
+		return true;
+	}
+
+	void Environment::save_tables(const std::string& filepath, std::uint64_t source_size, std::int64_t source_time) const noexcept
+	{
+		std::ofstream file(filepath, std::ios::out | std::ios::binary);
+
+		if (!file)
+		{
+			warning(std::format("unable to cache environment tables to `{}`", filepath));
+			return;
+		}
+
+		EnvironmentHeader header{};
+		std::memcpy(header.magic, TABLE_MAGIC, sizeof(TABLE_MAGIC));
+
+		header.version = TABLE_VERSION;
+		header.width = _width;
+		header.height = _height;
+		header.source_size = source_size;
+		header.source_time = source_time;
+
+		const auto write = [&](const void* bytes, std::size_t count)
+		{
+			file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(count));
+		};
+
+		write(&header, sizeof(header));
+		write(_pdf.data(), _pdf.size() * sizeof(float));
+		write(_rows.data(), _rows.size() * sizeof(AliasEntry));
+		write(_columns.data(), _columns.size() * sizeof(AliasEntry));
+	}
+
+	bool Environment::load(const std::string& filepath) noexcept
+	{
+		MappedFile file{};
+
+		if (!file.open(filepath))
+		{
+			log(std::format("error opening environment map `{}`", filepath));
+			return false;
+		}
+
+		auto width = 0, height = 0, channels = 0;
+		const auto pixels = stbi_loadf_from_memory(reinterpret_cast<const stbi_uc*>(file.data()), static_cast<int>(file.size()), &width, &height, &channels, 3);
+
+		if (pixels == nullptr)
+		{
+			log(std::format("invalid environment map `{}`: {}", filepath, stbi_failure_reason()));
+			return false;
+		}
+
+		_width = static_cast<std::uint32_t>(width);
+		_height = static_cast<std::uint32_t>(height);
+
+		_texels.resize(static_cast<std::size_t>(_width) * _height);
+
+		for (auto i = 0u; i < _texels.size(); i++)
+		{
+			_texels[i] = { pixels[3 * i + 0], pixels[3 * i + 1], pixels[3 * i + 2] };
+		}
+
+		stbi_image_free(pixels);
+
+		// the cache is only trusted for the exact file it was built from
+		std::error_code error{};
+		const auto source_size = static_cast<std::uint64_t>(file.size());
+		const auto source_time = static_cast<std::int64_t>(std::filesystem::last_write_time(filepath, error).time_since_epoch().count());
+
+		const auto tables = ::table_path(filepath);
+
+		if (load_tables(tables, source_size, source_time))
+		{
+			log(std::format("loaded {}x{} environment map `{}` with cached sampling tables", _width, _height, filepath));
+			return true;
+		}
+
+		fx::Timer timer{};
+		build_tables();
+		log(std::format("built sampling tables for {}x{} environment map `{}` in {:.1f} ms", _width, _height, filepath, timer.milliseconds()));
+
+		save_tables(tables, source_size, source_time);
+
+		return true;
+	}
+
+	fx::vec3 Environment::lookup(const fx::vec3& dir) const noexcept
+	{
+		auto sin_theta = 0.f;
+		return _texels[::texel(dir, _width, _height, sin_theta)];
+	}
+
+	fx::vec3 Environment::sample(const fx::vec2& uv, fx::vec3& radiance, float& pdf) const noexcept
+	{
+		auto v_offset = 0.f, u_offset = 0.f;
+
+		const auto y = ::pick(_rows, uv[1], v_offset);
+		const auto x = ::pick({ _columns.data() + y * _width, _width }, uv[0], u_offset);
+
+		const auto theta = fx::pi() * (y + v_offset) / _height;
+		const auto phi = 2.f * fx::pi() * (x + u_offset) / _width;
+
+		const auto sin_theta = std::sin(theta);
+		const fx::vec3 dir{ sin_theta * std::cos(phi), -std::cos(theta), sin_theta * std::sin(phi) };
+
+		const auto index = y * _width + x;
+
+		radiance = _texels[index];
+		pdf = ::solid_angle_pdf(_pdf[index], _width, _height, sin_theta);
+
+		return dir;
+	}
+}
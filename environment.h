@@ -0,0 +1,68 @@
+#ifndef LUMA_ENVIRONMENT_H
+#define LUMA_ENVIRONMENT_H
+
+#include "flux/types.h"
+
+// environment.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// sampling tables are cached next to the map as <map>.alias so that large maps load without
+	// rebuilding them; the cache is rebuilt whenever the map's size or modification time changes
+	//
+	//   EnvironmentHeader
+	//   float[width * height]        probability of each texel
+	//   AliasEntry[height]           rows, in proportion to their total weight
+	//   AliasEntry[width * height]   columns within each row
+	struct EnvironmentHeader
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t width, height;
+		std::uint32_t reserved;
+		std::uint64_t source_size;
+		std::int64_t source_time;
+	};
+
+	// walker's alias method: slot i is kept with the given probability, otherwise its alias is taken,
+	// so a discrete distribution of any size is sampled in constant time
+	struct AliasEntry
+	{
+		float probability;
+		std::uint32_t alias;
+	};
+
+	// equirectangular radiance map around the scene; up is -y, matching the camera
+	class Environment
+	{
+	public:
+		static constexpr char TABLE_MAGIC[8]{ 'L', 'U', 'M', 'A', 'E', 'N', 'V', '\0' };
+		static constexpr std::uint32_t TABLE_VERSION = 1;
+
+	private:
+		std::uint32_t _width = 0, _height = 0;
+		std::vector<fx::vec3> _texels;
+
+		// texels are importance sampled in proportion to luminance times the solid angle they cover
+		std::vector<float> _pdf;
+		std::vector<AliasEntry> _rows, _columns;
+
+	private:
+		void build_tables(void) noexcept;
+		bool load_tables(const std::string&, std::uint64_t, std::int64_t) noexcept;
+		void save_tables(const std::string&, std::uint64_t, std::int64_t) const noexcept;
+
+	public:
+		bool load(const std::string&) noexcept;
+
+		fx::vec3 lookup(const fx::vec3&) const noexcept;
+		// draws a direction in proportion to the radiance arriving from it and returns its solid angle density
+		fx::vec3 sample(const fx::vec2&, fx::vec3& radiance, float& pdf) const noexcept;
+
+	public:
+		bool empty(void) const noexcept { return _texels.empty(); }
+	};
+}
+
+#endif
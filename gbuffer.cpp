@@ -0,0 +1,26 @@
+import std;
+
+#include "gbuffer.h"
+
+// gbuffer.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	void GBuffer::resize(std::size_t size) noexcept
+	{
+		_hits.assign(size, Hit{ 0.f, Hit::NONE });
+
+		invalidate();
+	}
+
+	void GBuffer::invalidate(void) noexcept
+	{
+		_valid = false;
+	}
+
+	void GBuffer::commit(void) noexcept
+	{
+		_valid = true;
+	}
+}
@@ -0,0 +1,40 @@
+#ifndef LUMA_GBUFFER_H
+#define LUMA_GBUFFER_H
+
+#include "geometry.h"
+
+// gbuffer.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// primary hits kept across accumulation frames while the camera and scene stay still; normals and
+	// materials are cheap to rebuild from the primitive, so only the compact Hit is stored
+	//
+	// one unjittered hit is kept per pixel, which gives the focus distance and serves pinhole modes as
+	// is. jittered primary rays test the sphere it names first and only traverse in front of it, so a
+	// full traversal is left for the rays that jitter off that sphere
+	//
+	// 8 bytes per pixel, about 16 MB at 1080p
+	class GBuffer
+	{
+	private:
+		std::vector<Hit> _hits;
+		bool _valid = false;
+
+	public:
+		void resize(std::size_t) noexcept;
+		// drops every cached hit, e.g. after the camera moved or geometry changed
+		void invalidate(void) noexcept;
+		// marks the hits as complete once a frame has written them
+		void commit(void) noexcept;
+
+	public:
+		bool valid(void) const noexcept { return _valid; }
+
+		Hit& primary(std::size_t pixel) noexcept { return _hits[pixel]; }
+		const Hit& primary(std::size_t pixel) const noexcept { return _hits[pixel]; }
+	};
+}
+
+#endif
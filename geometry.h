@@ -0,0 +1,167 @@
+#ifndef LUMA_GEOMETRY_H
+#define LUMA_GEOMETRY_H
+
+#include "flux/types.h"
+
+// geometry.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	struct Ray
+	{
+		fx::vec3 pos, dir;
+	};
+
+	// both camera transforms applied to the basis vectors, from which every primary ray is a weighted sum
+	struct RayBasis
+	{
+		// inverse projection of one unit along x and y in clip space, and of the view center
+		fx::vec4 along_x, along_y, center;
+		// inverse view rotation of the eye-space axes
+		fx::vec3 axes[3];
+	};
+
+	struct Material
+	{
+		fx::vec3 diffuse;
+		float albedo; // controls the amount of indirect light recieved
+		float metallic; // controls the strength of reflections
+		float roughness; // controls the dispersion of reflections
+		fx::vec3 emission{}; // radiance given off by spheres of this material, which makes them lights
+	};
+
+	struct Sphere
+	{
+		fx::vec3 pos;
+		float radius;
+		std::uint16_t material; // index into the scene's material table
+	};
+
+	// geometry-only copy of a sphere laid out for the acceleration structures
+	struct PackedSphere
+	{
+		float x, y, z, radius;
+	};
+
+	// traversal result; position, normal and material are only derived once the closest hit is known
+	struct Hit
+	{
+		static constexpr auto NONE = std::numeric_limits<std::uint32_t>::max();
+
+		float distance;
+		std::uint32_t primitive;
+	};
+
+	static_assert(sizeof(Hit) == 8);
+
+	// closest intersection in front of the ray, in the given precision; traversal runs in float, and
+	// resolving a hit may repeat the test in double where float cannot place it accurately
+	template<std::floating_point T>
+	inline bool intersect_sphere(const Ray& ray, const PackedSphere& sphere, T& distance) noexcept
+	{
+		const T dir[3]{ ray.dir[0], ray.dir[1], ray.dir[2] };
+
+		const auto dx = static_cast<T>(ray.pos[0]) - sphere.x;
+		const auto dy = static_cast<T>(ray.pos[1]) - sphere.y;
+		const auto dz = static_cast<T>(ray.pos[2]) - sphere.z;
+
+		const auto a = dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2];
+		const auto b = 2 * (dx * dir[0] + dy * dir[1] + dz * dir[2]);
+		const auto c = (dx * dx + dy * dy + dz * dz) - (static_cast<T>(sphere.radius) * sphere.radius);
+
+		// descriminant
+		const auto d = (b * b) - (4 * a * c);
+
+		if (d <= 0) [[likely]]
+		{
+			return false;
+		}
+
+		distance = (-b - std::sqrt(d)) / (2 * a);
+
+		return distance > 0;
+	}
+
+	// point at a distance along the ray, formed in the precision the distance was found in
+	template<std::floating_point T>
+	inline fx::vec3 hit_position(const Ray& ray, T distance) noexcept
+	{
+		auto func = [&](std::size_t axis)
+		{
+			return static_cast<float>(ray.pos[axis] + static_cast<T>(ray.dir[axis]) * distance);
+		};
+
+		return { func(0), func(1), func(2) };
+	}
+
+	// tangent and bitangent completing a unit vector to a right-handed orthonormal basis, without a
+	// branch or a singularity at either pole (duff et al. 2017)
+	inline void orthonormal_basis(const fx::vec3& w, fx::vec3& tangent, fx::vec3& bitangent) noexcept
+	{
+		const auto sign = std::copysign(1.f, w[2]);
+		const auto a = -1.f / (sign + w[2]);
+		const auto b = w[0] * w[1] * a;
+
+		tangent = { 1.f + sign * w[0] * w[0] * a, sign * b, -sign * w[0] };
+		bitangent = { b, sign + w[1] * w[1] * a, -w[1] };
+	}
+
+	// direction uniformly distributed over the unit sphere; added to a unit normal, it gives one
+	// distributed by the cosine about that normal
+	inline fx::vec3 uniform_sphere(const fx::vec2& sample) noexcept
+	{
+		const auto z = 1.f - 2.f * sample[0];
+		const auto r = std::sqrt(std::max(0.f, 1.f - z * z));
+		const auto phi = 2.f * std::numbers::pi_v<float> * sample[1];
+
+		return { r * std::cos(phi), r * std::sin(phi), z };
+	}
+
+	// 1 - cos of the cone a sphere subtends from a point outside it, from sin^2 so that small, distant
+	// spheres do not lose their whole solid angle to cancellation
+	inline float cone_extent(float radius, float distance) noexcept
+	{
+		const auto sin_max2 = (radius * radius) / (distance * distance);
+		return sin_max2 / (1.f + std::sqrt(1.f - sin_max2));
+	}
+
+	// spatial hash of an integer grid cell (teschner et al. 2003), to be reduced to a table size by the caller
+	inline std::uint32_t cell_hash(const std::array<std::int32_t, 3>& cell) noexcept
+	{
+		const auto x = static_cast<std::uint32_t>(cell[0]) * 73856093u;
+		const auto y = static_cast<std::uint32_t>(cell[1]) * 19349663u;
+		const auto z = static_cast<std::uint32_t>(cell[2]) * 83492791u;
+
+		return x ^ y ^ z;
+	}
+
+	// start of a ray leaving a surface, moved off it along the normal far enough that rounding cannot put
+	// it back inside; the step is a fixed number of ulps, so it scales with the magnitude of each
+	// coordinate instead of being one distance for every scene (wachter and binder 2019)
+	inline fx::vec3 offset_origin(const fx::vec3& pos, const fx::vec3& normal) noexcept
+	{
+		// ulps are tiny close to zero, where a fixed step takes over
+		constexpr auto ORIGIN = 1.f / 32.f;
+		constexpr auto FLOAT_SCALE = 1.f / 65536.f;
+		constexpr auto INT_SCALE = 256.f;
+
+		auto func = [&](std::size_t axis)
+		{
+			if (std::abs(pos[axis]) < ORIGIN)
+			{
+				return pos[axis] + FLOAT_SCALE * normal[axis];
+			}
+
+			// stepping the bit pattern moves away from zero for positive values, so negative ones step the other way
+			const auto step = static_cast<std::int32_t>(INT_SCALE * normal[axis]);
+			const auto bits = std::bit_cast<std::int32_t>(pos[axis]);
+
+			return std::bit_cast<float>(bits + (pos[axis] < 0 ? -step : step));
+		};
+
+		return { func(0), func(1), func(2) };
+	}
+}
+
+#endif
@@ -0,0 +1,308 @@
+import std;
+
+#include "grid.h"
+
+// grid.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	static constexpr auto MAX_RESOLUTION = 1 << 16;
+
+	// below this many spheres the BVH is always the better choice
+	static constexpr auto MINIMUM_COUNT = 1024u;
+
+	// coefficient of variation and largest-to-mean ratio of the radii that still count as "similarly sized"
+	static constexpr auto MAXIMUM_VARIATION = .5f;
+	static constexpr auto MAXIMUM_SPREAD = 4.f;
+}
+
+namespace luma
+{
+	std::uint32_t Grid::bucket(std::int32_t x, std::int32_t y, std::int32_t z) const noexcept
+	{
+		if (_hashed)
+		{
+			return cell_hash({ x, y, z }) & _mask;
+		}
+
+		return static_cast<std::uint32_t>((z * _resolution[1] + y) * _resolution[0] + x);
+	}
+
+	bool Grid::suitable(std::span<const PackedSphere> spheres) noexcept
+	{
+		if (spheres.size() < MINIMUM_COUNT)
+		{
+			return false;
+		}
+
+		auto sum = 0.0, sum_squared = 0.0, largest = 0.0;
+
+		for (const auto& sphere : spheres)
+		{
+			sum += sphere.radius;
+			sum_squared += sphere.radius * sphere.radius;
+			largest = std::max(largest, static_cast<double>(sphere.radius));
+		}
+
+		const auto count = static_cast<double>(spheres.size());
+		const auto mean = sum / count;
+
+		if (mean <= 0)
+		{
+			return false;
+		}
+
+		const auto variance = std::max(sum_squared / count - mean * mean, 0.0);
+		const auto variation = std::sqrt(variance) / mean;
+
+		return variation < MAXIMUM_VARIATION && largest / mean < MAXIMUM_SPREAD;
+	}
+
+	void Grid::build(std::span<const PackedSphere> spheres) noexcept
+	{
+		_offsets.clear();
+		_references.clear();
+		_spheres = spheres;
+
+		if (spheres.empty())
+		{
+			return;
+		}
+
+		float lo[3], hi[3];
+
+		for (auto axis = 0; axis < 3; axis++)
+		{
+			lo[axis] = std::numeric_limits<float>::max();
+			hi[axis] = std::numeric_limits<float>::lowest();
+		}
+
+		auto radius_sum = 0.0;
+
+		for (const auto& sphere : spheres)
+		{
+			const float center[3]{ sphere.x, sphere.y, sphere.z };
+
+			for (auto axis = 0; axis < 3; axis++)
+			{
+				lo[axis] = std::min(lo[axis], center[axis] - sphere.radius);
+				hi[axis] = std::max(hi[axis], center[axis] + sphere.radius);
+			}
+
+			radius_sum += sphere.radius;
+		}
+
+		const auto count = static_cast<float>(spheres.size());
+		const auto mean_radius = static_cast<float>(radius_sum / spheres.size());
+
+		auto volume = 1.f;
+		auto largest_extent = 0.f;
+
+		for (auto axis = 0; axis < 3; axis++)
+		{
+			_origin[axis] = lo[axis];
+			_extent[axis] = std::max(hi[axis] - lo[axis], std::numeric_limits<float>::min());
+
+			volume *= _extent[axis];
+			largest_extent = std::max(largest_extent, _extent[axis]);
+		}
+
+		// cells sized from the average spacing, but kept within a few sphere diameters so clustered
+		// data still gets fine cells where the spheres are (the hash table absorbs the empty space)
+		_cell_size = std::clamp(std::cbrt(volume * DENSITY / count), 2 * mean_radius, 8 * mean_radius);
+		_cell_size = std::max(_cell_size, largest_extent / MAX_RESOLUTION);
+		_inverse_cell_size = 1.f / _cell_size;
+
+		auto dense_cells = std::uint64_t{ 1 };
+
+		for (auto axis = 0; axis < 3; axis++)
+		{
+			_resolution[axis] = std::clamp(static_cast<std::int32_t>(std::ceil(_extent[axis] * _inverse_cell_size)), 1, MAX_RESOLUTION);
+			dense_cells *= static_cast<std::uint64_t>(_resolution[axis]);
+		}
+
+		// mostly-empty grids are folded into a power-of-two hash table
+		_hashed = dense_cells > 4 * static_cast<std::uint64_t>(spheres.size()) + 64;
+
+		auto bucket_count = static_cast<std::uint32_t>(dense_cells);
+
+		if (_hashed)
+		{
+			bucket_count = std::bit_ceil(static_cast<std::uint32_t>(2 * spheres.size()));
+			_mask = bucket_count - 1;
+		}
+
+		const auto range = [&](const PackedSphere& sphere, std::int32_t* first, std::int32_t* last)
+		{
+			const float center[3]{ sphere.x, sphere.y, sphere.z };
+
+			for (auto axis = 0; axis < 3; axis++)
+			{
+				const auto lower = (center[axis] - sphere.radius - _origin[axis]) * _inverse_cell_size;
+				const auto upper = (center[axis] + sphere.radius - _origin[axis]) * _inverse_cell_size;
+
+				first[axis] = std::clamp(static_cast<std::int32_t>(lower), 0, _resolution[axis] - 1);
+				last[axis] = std::clamp(static_cast<std::int32_t>(upper), 0, _resolution[axis] - 1);
+			}
+		};
+
+		const auto visit = [&](auto&& function)
+		{
+			for (auto i = 0u; i < _spheres.size(); i++)
+			{
+				std::int32_t first[3], last[3];
+				range(_spheres[i], first, last);
+
+				for (auto z = first[2]; z <= last[2]; z++)
+				{
+					for (auto y = first[1]; y <= last[1]; y++)
+					{
+						for (auto x = first[0]; x <= last[0]; x++)
+						{
+							function(bucket(x, y, z), i);
+						}
+					}
+				}
+			}
+		};
+
+		// counting sort: size every bucket, prefix sum, then scatter the references
+		_offsets.assign(static_cast<std::size_t>(bucket_count) + 1, 0);
+
+		visit([&](std::uint32_t bucket, std::uint32_t)
+		{
+			_offsets[bucket + 1]++;
+		});
+
+		std::inclusive_scan(_offsets.begin(), _offsets.end(), _offsets.begin());
+
+		_references.resize(_offsets.back());
+
+		auto cursor = std::vector<std::uint32_t>(_offsets.begin(), _offsets.end() - 1);
+
+		visit([&](std::uint32_t bucket, std::uint32_t primitive)
+		{
+			_references[cursor[bucket]++] = primitive;
+		});
+	}
+
+	Hit Grid::intersect(const Ray& ray, float max) const noexcept
+	{
+		static constexpr auto EPSILON = 1e-20f;
+
+		Hit hit{ max, Hit::NONE };
+
+		if (_spheres.empty())
+		{
+			return hit;
+		}
+
+		float inverse[3];
+
+		auto enter = 0.f;
+		auto leave = max;
+
+		// clip the ray against the grid bounds
+		for (auto axis = 0; axis < 3; axis++)
+		{
+			auto dir = ray.dir[axis];
+
+			if (std::abs(dir) < EPSILON)
+			{
+				dir = std::copysign(EPSILON, dir);
+			}
+
+			inverse[axis] = 1.f / dir;
+
+			auto near = (_origin[axis] - ray.pos[axis]) * inverse[axis];
+			auto far = (_origin[axis] + _extent[axis] - ray.pos[axis]) * inverse[axis];
+
+			if (near > far)
+			{
+				std::swap(near, far);
+			}
+
+			enter = std::max(enter, near);
+			leave = std::min(leave, far);
+		}
+
+		if (enter > leave)
+		{
+			return hit;
+		}
+
+		std::int32_t cell[3], step[3], stop[3];
+		float next[3], delta[3];
+
+		for (auto axis = 0; axis < 3; axis++)
+		{
+			const auto start = ray.pos[axis] + ray.dir[axis] * enter;
+			const auto index = static_cast<std::int32_t>((start - _origin[axis]) * _inverse_cell_size);
+
+			cell[axis] = std::clamp(index, 0, _resolution[axis] - 1);
+
+			if (inverse[axis] >= 0)
+			{
+				step[axis] = 1;
+				stop[axis] = _resolution[axis];
+				next[axis] = (_origin[axis] + (cell[axis] + 1) * _cell_size - ray.pos[axis]) * inverse[axis];
+				delta[axis] = _cell_size * inverse[axis];
+			}
+
+			else
+			{
+				step[axis] = -1;
+				stop[axis] = -1;
+				next[axis] = (_origin[axis] + cell[axis] * _cell_size - ray.pos[axis]) * inverse[axis];
+				delta[axis] = -_cell_size * inverse[axis];
+			}
+		}
+
+		while (true)
+		{
+			const auto index = bucket(cell[0], cell[1], cell[2]);
+
+			for (auto i = _offsets[index]; i < _offsets[index + 1]; i++)
+			{
+				const auto primitive = _references[i];
+
+				auto distance = 0.f;
+
+				if (intersect_sphere(ray, _spheres[primitive], distance) && distance < hit.distance)
+				{
+					hit = { distance, primitive };
+				}
+			}
+
+			auto axis = 0;
+
+			if (next[1] < next[axis]) axis = 1;
+			if (next[2] < next[axis]) axis = 2;
+
+			// any sphere hit closer than this cell's exit cannot be beaten by a later cell
+			if (hit.distance <= next[axis] || next[axis] > leave)
+			{
+				break;
+			}
+
+			cell[axis] += step[axis];
+
+			if (cell[axis] == stop[axis])
+			{
+				break;
+			}
+
+			next[axis] += delta[axis];
+		}
+
+		return hit;
+	}
+
+	bool Grid::occluded(const Ray& ray, float max) const noexcept
+	{
+		// the dda already visits cells front to back and stops in the first one holding a hit, so
+		// ending on any hit would only skip the remaining spheres of that one cell
+		return intersect(ray, max).primitive != Hit::NONE;
+	}
+}
@@ -0,0 +1,52 @@
+#ifndef LUMA_GRID_H
+#define LUMA_GRID_H
+
+#include "geometry.h"
+
+// grid.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// uniform grid over the scene bounds, traversed with a 3D-DDA; sparse scenes fold the
+	// logical cells into a hash table so memory stays proportional to the sphere count
+	class Grid
+	{
+	public:
+		// average number of spheres per occupied cell the resolution is tuned for
+		static constexpr auto DENSITY = 2.f;
+
+	private:
+		float _origin[3]{};
+		float _extent[3]{};
+		float _cell_size = 1.f, _inverse_cell_size = 1.f;
+		std::int32_t _resolution[3]{};
+
+		bool _hashed = false;
+		std::uint32_t _mask = 0;
+
+		// cell i references _references[_offsets[i].._offsets[i + 1]]
+		std::vector<std::uint32_t> _offsets;
+		std::vector<std::uint32_t> _references;
+		std::span<const PackedSphere> _spheres;
+
+	private:
+		std::uint32_t bucket(std::int32_t, std::int32_t, std::int32_t) const noexcept;
+
+	public:
+		// true when the spheres are numerous and similarly sized enough for a grid to beat the BVH
+		static bool suitable(std::span<const PackedSphere>) noexcept;
+
+	public:
+		// references the spheres in place, so they must outlive the grid
+		void build(std::span<const PackedSphere>) noexcept;
+		Hit intersect(const Ray&, float = std::numeric_limits<float>::max()) const noexcept;
+		// any-hit query for shadow and occlusion rays; stops at the first sphere within range
+		bool occluded(const Ray&, float = std::numeric_limits<float>::max()) const noexcept;
+
+	public:
+		std::size_t cell_count(void) const noexcept { return _offsets.empty() ? 0 : _offsets.size() - 1; }
+	};
+}
+
+#endif
@@ -0,0 +1,409 @@
+import std;
+
+#include "flux/vector.h"
+#include "guiding.h"
+#include "sampler.h"
+
+// guiding.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	fx::vec2 to_square(const fx::vec3& dir) noexcept
+	{
+		const auto cos_theta = std::clamp(dir[2], -1.f, 1.f);
+		auto phi = std::atan2(dir[1], dir[0]);
+
+		if (phi < 0.f)
+		{
+			phi += 2.f * fx::pi();
+		}
+
+		return { std::min((cos_theta + 1.f) * .5f, luma::ONE_MINUS_EPSILON), std::min(phi / (2.f * fx::pi()), luma::ONE_MINUS_EPSILON) };
+	}
+
+	fx::vec3 from_square(const fx::vec2& point) noexcept
+	{
+		const auto cos_theta = 2.f * point[0] - 1.f;
+		const auto sin_theta = std::sqrt(std::max(0.f, 1.f - cos_theta * cos_theta));
+		const auto phi = 2.f * fx::pi() * point[1];
+
+		return { sin_theta * std::cos(phi), sin_theta * std::sin(phi), cos_theta };
+	}
+
+	// quadrant of the unit square a point lies in; bit 0 is the upper half in x, bit 1 in y
+	std::uint32_t quadrant(fx::vec2& point) noexcept
+	{
+		auto index = 0u;
+
+		for (auto axis = 0u; axis < 2; axis++)
+		{
+			if (point[axis] >= .5f)
+			{
+				index |= 1u << axis;
+				point[axis] -= .5f;
+			}
+
+			point[axis] *= 2.f;
+		}
+
+		return index;
+	}
+
+	// chooses the lower option with the given weight and rescales the sample for reuse
+	bool choose_lower(float lower, float upper, float& u) noexcept
+	{
+		const auto total = lower + upper;
+		const auto probability = total > 0.f ? lower / total : .5f;
+
+		if (u < probability)
+		{
+			u = std::min(u / probability, luma::ONE_MINUS_EPSILON);
+			return true;
+		}
+
+		u = std::min((u - probability) / (1.f - probability), luma::ONE_MINUS_EPSILON);
+		return false;
+	}
+}
+
+namespace luma
+{
+	DirectionTree::Node::Node(const Node& other) noexcept
+	{
+		*this = other;
+	}
+
+	DirectionTree::Node& DirectionTree::Node::operator=(const Node& other) noexcept
+	{
+		for (auto i = 0u; i < 4; i++)
+		{
+			sum[i].store(other.sum[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+
+		child = other.child;
+		return *this;
+	}
+
+	DirectionTree::DirectionTree(void) noexcept
+	{
+		_nodes.emplace_back();
+	}
+
+	void DirectionTree::record(const fx::vec3& dir, float radiance) noexcept
+	{
+		auto point = ::to_square(dir);
+		auto node = 0u;
+
+		for (;;)
+		{
+			const auto index = ::quadrant(point);
+			const auto child = _nodes[node].child[index];
+
+			// only leaves are written; interior sums are rebuilt from them in build()
+			if (child == 0)
+			{
+				_nodes[node].sum[index].fetch_add(radiance, std::memory_order_relaxed);
+				return;
+			}
+
+			node = child;
+		}
+	}
+
+	float DirectionTree::build(std::uint32_t node) noexcept
+	{
+		auto total = 0.f;
+
+		for (auto i = 0u; i < 4; i++)
+		{
+			const auto child = _nodes[node].child[i];
+
+			if (child != 0)
+			{
+				_nodes[node].sum[i].store(build(child), std::memory_order_relaxed);
+			}
+
+			total += _nodes[node].sum[i].load(std::memory_order_relaxed);
+		}
+
+		return total;
+	}
+
+	void DirectionTree::build(void) noexcept
+	{
+		_total = build(0);
+	}
+
+	void DirectionTree::reshape(const DirectionTree& trained, std::uint32_t source, float energy, std::uint32_t node, std::uint32_t depth, float limit) noexcept
+	{
+		for (auto i = 0u; i < 4; i++)
+		{
+			// below the trained tree's leaves each quadrant inherits an even share of the energy above it
+			auto child_source = NO_SOURCE;
+			auto child_energy = .25f * energy;
+
+			if (source != NO_SOURCE)
+			{
+				child_source = trained._nodes[source].child[i] != 0 ? trained._nodes[source].child[i] : NO_SOURCE;
+				child_energy = trained._nodes[source].sum[i].load(std::memory_order_relaxed);
+			}
+
+			if (child_energy <= limit || depth >= MAX_DEPTH)
+			{
+				continue;
+			}
+
+			const auto child = static_cast<std::uint32_t>(_nodes.size());
+			_nodes.emplace_back();
+			_nodes[node].child[i] = child;
+
+			reshape(trained, child_source, child_energy, child, depth + 1, limit);
+		}
+	}
+
+	void DirectionTree::reshape(const DirectionTree& trained, float threshold) noexcept
+	{
+		_nodes.clear();
+		_nodes.emplace_back();
+		_total = 0.f;
+
+		if (trained._total > 0.f)
+		{
+			reshape(trained, 0, trained._total, 0, 1, threshold * trained._total);
+		}
+	}
+
+	fx::vec3 DirectionTree::sample(const fx::vec2& uv) const noexcept
+	{
+		if (_total <= 0.f)
+		{
+			return ::from_square(uv);
+		}
+
+		auto u = uv[0], v = uv[1];
+
+		fx::vec2 origin{ 0.f, 0.f };
+		auto size = 1.f;
+		auto node = 0u;
+
+		for (;;)
+		{
+			const auto& sum = _nodes[node].sum;
+
+			const auto s0 = sum[0].load(std::memory_order_relaxed);
+			const auto s1 = sum[1].load(std::memory_order_relaxed);
+			const auto s2 = sum[2].load(std::memory_order_relaxed);
+			const auto s3 = sum[3].load(std::memory_order_relaxed);
+
+			// pick the half in x, then the quadrant within it in y
+			const auto lower_x = ::choose_lower(s0 + s2, s1 + s3, u);
+			const auto lower_y = lower_x ? ::choose_lower(s0, s2, v) : ::choose_lower(s1, s3, v);
+
+			const auto index = (lower_x ? 0u : 1u) | (lower_y ? 0u : 2u);
+
+			size *= .5f;
+			origin[0] += (index & 1u) ? size : 0.f;
+			origin[1] += (index & 2u) ? size : 0.f;
+
+			const auto child = _nodes[node].child[index];
+
+			if (child == 0)
+			{
+				return ::from_square({ origin[0] + u * size, origin[1] + v * size });
+			}
+
+			node = child;
+		}
+	}
+
+	float DirectionTree::pdf(const fx::vec3& dir) const noexcept
+	{
+		// the cylindrical mapping spreads the unit square over 4 pi steradians
+		const auto uniform = 1.f / (4.f * fx::pi());
+
+		if (_total <= 0.f)
+		{
+			return uniform;
+		}
+
+		auto point = ::to_square(dir);
+		auto node = 0u;
+		auto density = uniform;
+
+		for (;;)
+		{
+			const auto& sum = _nodes[node].sum;
+
+			auto total = 0.f;
+			for (const auto& value : sum)
+			{
+				total += value.load(std::memory_order_relaxed);
+			}
+
+			const auto index = ::quadrant(point);
+
+			if (total <= 0.f)
+			{
+				return density;
+			}
+
+			density *= 4.f * sum[index].load(std::memory_order_relaxed) / total;
+
+			const auto child = _nodes[node].child[index];
+
+			if (child == 0 || density <= 0.f)
+			{
+				return density;
+			}
+
+			node = child;
+		}
+	}
+
+	Guide::Leaf::Leaf(const Leaf& other) noexcept
+		: sampling(other.sampling), building(other.building), samples(other.samples.load(std::memory_order_relaxed))
+	{
+	}
+
+	void Guide::reset(const fx::vec3& min, const fx::vec3& max) noexcept
+	{
+		// cubic cells keep the octree's subdivision even in every direction
+		auto extent = 0.f;
+		for (auto axis = 0; axis < 3; axis++)
+		{
+			extent = std::max(extent, max[axis] - min[axis]);
+		}
+
+		const auto center = fx::scale(fx::add(min, max), .5f);
+		const auto half = .5f * extent * 1.01f + 1e-3f;
+
+		_min = fx::subtract(center, fx::vec3{ half, half, half });
+		_max = fx::add(center, fx::vec3{ half, half, half });
+
+		_cells.assign(1, Cell{ 0, 0 });
+		_leaves.clear();
+		_leaves.emplace_back();
+
+		_iteration = 0;
+		_frames = 0;
+	}
+
+	std::uint32_t Guide::leaf(const fx::vec3& pos) const noexcept
+	{
+		auto lo = _min;
+		auto hi = _max;
+		auto cell = 0u;
+
+		while (_cells[cell].child != 0)
+		{
+			auto octant = 0u;
+
+			for (auto axis = 0; axis < 3; axis++)
+			{
+				const auto mid = .5f * (lo[axis] + hi[axis]);
+
+				if (pos[axis] >= mid)
+				{
+					octant |= 1u << axis;
+					lo[axis] = mid;
+				}
+
+				else
+				{
+					hi[axis] = mid;
+				}
+			}
+
+			cell = _cells[cell].child + octant;
+		}
+
+		return _cells[cell].leaf;
+	}
+
+	void Guide::record(std::uint32_t leaf, const fx::vec3& dir, float radiance) noexcept
+	{
+		auto& target = _leaves[leaf];
+
+		target.building.record(dir, radiance);
+		target.samples.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void Guide::subdivide(std::uint32_t cell) noexcept
+	{
+		const auto leaf = _cells[cell].leaf;
+		const auto first = static_cast<std::uint32_t>(_cells.size());
+
+		// every child starts from the parent's trees and an even share of its samples
+		const auto samples = _leaves[leaf].samples.load(std::memory_order_relaxed) / 8;
+		_leaves[leaf].samples.store(samples, std::memory_order_relaxed);
+
+		for (auto i = 0u; i < 8; i++)
+		{
+			auto child_leaf = leaf;
+
+			if (i > 0)
+			{
+				child_leaf = static_cast<std::uint32_t>(_leaves.size());
+				_leaves.emplace_back(_leaves[leaf]);
+			}
+
+			_cells.push_back({ 0, child_leaf });
+		}
+
+		_cells[cell].child = first;
+	}
+
+	void Guide::refine(void) noexcept
+	{
+		const auto threshold = SPATIAL_THRESHOLD * std::sqrt(static_cast<float>(1u << _iteration));
+
+		// newly created cells are visited by the same loop, so dense regions split repeatedly
+		for (auto cell = 0u; cell < _cells.size(); cell++)
+		{
+			if (_cells[cell].child == 0 && _leaves[_cells[cell].leaf].samples.load(std::memory_order_relaxed) > threshold)
+			{
+				subdivide(cell);
+			}
+		}
+
+		for (auto& leaf : _leaves)
+		{
+			leaf.building.build();
+			leaf.sampling = leaf.building;
+			leaf.building.reshape(leaf.sampling, ENERGY_THRESHOLD);
+			leaf.samples.store(0, std::memory_order_relaxed);
+		}
+
+		_iteration++;
+	}
+
+	bool Guide::advance(void) noexcept
+	{
+		if (!training())
+		{
+			return false;
+		}
+
+		// iteration k lasts 2^k frames, so later iterations learn from ever more samples
+		if (++_frames < (1u << _iteration))
+		{
+			return false;
+		}
+
+		_frames = 0;
+		refine();
+
+		return true;
+	}
+
+	fx::vec3 Guide::sample(std::uint32_t leaf, const fx::vec2& uv) const noexcept
+	{
+		return _leaves[leaf].sampling.sample(uv);
+	}
+
+	float Guide::pdf(std::uint32_t leaf, const fx::vec3& dir) const noexcept
+	{
+		return _leaves[leaf].sampling.pdf(dir);
+	}
+}
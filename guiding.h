@@ -0,0 +1,124 @@
+#ifndef LUMA_GUIDING_H
+#define LUMA_GUIDING_H
+
+#include "flux/types.h"
+
+// guiding.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// quadtree over the unit square that cylindrical coordinates (cos theta, phi) map the sphere of
+	// directions onto; the mapping preserves area, so a cell's share of the square is its share of
+	// the sphere and densities convert to solid angle by a constant 1 / 4 pi
+	class DirectionTree
+	{
+	public:
+		static constexpr auto MAX_DEPTH = 20u;
+
+	private:
+		static constexpr auto NO_SOURCE = std::numeric_limits<std::uint32_t>::max();
+
+		struct Node
+		{
+			// recorded energy of each quadrant, written concurrently while training
+			std::array<std::atomic<float>, 4> sum{};
+			// index of each quadrant's node, zero for leaves since the root is nobody's child
+			std::array<std::uint32_t, 4> child{};
+
+			Node(void) noexcept = default;
+			Node(const Node&) noexcept;
+			Node& operator=(const Node&) noexcept;
+		};
+
+		std::vector<Node> _nodes;
+		float _total = 0.f;
+
+	private:
+		float build(std::uint32_t) noexcept;
+		void reshape(const DirectionTree&, std::uint32_t, float, std::uint32_t, std::uint32_t, float) noexcept;
+
+	public:
+		DirectionTree(void) noexcept;
+
+		// lock-free; many threads may record into the same tree
+		void record(const fx::vec3&, float) noexcept;
+		// sums every node's children so the tree can be sampled
+		void build(void) noexcept;
+		// rebuilds the structure from a trained tree, splitting cells holding more than the given
+		// fraction of its energy and merging the rest, with every sum cleared for the next iteration
+		void reshape(const DirectionTree&, float) noexcept;
+
+		fx::vec3 sample(const fx::vec2&) const noexcept;
+		float pdf(const fx::vec3&) const noexcept;
+
+	public:
+		float total(void) const noexcept { return _total; }
+		std::size_t node_count(void) const noexcept { return _nodes.size(); }
+	};
+
+	// spatial-directional tree for online path guiding (mueller et al. 2017): an octree over the
+	// scene whose leaves each hold a directional quadtree of the radiance arriving in that region
+	//
+	// training runs in iterations of doubling length; each iteration records into a building tree
+	// while sampling from the one finished by the previous iteration, then subdivides leaves that
+	// saw enough samples and turns the building trees into the next sampling trees
+	class Guide
+	{
+	public:
+		// a leaf splits once it has seen this many samples times the square root of the iteration's length
+		static constexpr auto SPATIAL_THRESHOLD = 4000.f;
+		static constexpr auto ENERGY_THRESHOLD = .01f;
+		static constexpr auto MAX_ITERATIONS = 10u;
+
+	private:
+		struct Cell
+		{
+			// first of eight children, zero for leaves
+			std::uint32_t child;
+			std::uint32_t leaf;
+		};
+
+		struct Leaf
+		{
+			DirectionTree sampling, building;
+			std::atomic<std::uint32_t> samples{ 0 };
+
+			Leaf(void) noexcept = default;
+			Leaf(const Leaf&) noexcept;
+		};
+
+		fx::vec3 _min, _max;
+		std::vector<Cell> _cells;
+		std::deque<Leaf> _leaves;
+
+		std::uint32_t _iteration = 0;
+		std::uint32_t _frames = 0;
+
+	private:
+		void subdivide(std::uint32_t) noexcept;
+		void refine(void) noexcept;
+
+	public:
+		void reset(const fx::vec3&, const fx::vec3&) noexcept;
+
+		std::uint32_t leaf(const fx::vec3&) const noexcept;
+
+		// lock-free, like DirectionTree::record
+		void record(std::uint32_t, const fx::vec3&, float) noexcept;
+		// counts a finished frame and refines once the current iteration has run its length
+		bool advance(void) noexcept;
+
+		fx::vec3 sample(std::uint32_t, const fx::vec2&) const noexcept;
+		float pdf(std::uint32_t, const fx::vec3&) const noexcept;
+
+	public:
+		// sampling trees exist once the first iteration has been refined
+		bool ready(void) const noexcept { return _iteration > 0; }
+		bool training(void) const noexcept { return _iteration < MAX_ITERATIONS; }
+		std::uint32_t iteration(void) const noexcept { return _iteration; }
+		std::size_t leaf_count(void) const noexcept { return _leaves.size(); }
+	};
+}
+
+#endif
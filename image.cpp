@@ -1,69 +1,208 @@
 import std;
 
+#include "encoders.h"
 #include "image.h"
 #include "log.h"
 
 // image.cpp
 // (c) 2025 Connor J. Link. All Rights Reserved.
 
+namespace
+{
+	// exports gather their bytes here and write them out a block at a time, so that neither the file
+	// stream nor the heap is touched per pixel
+	constexpr auto BLOCK_SIZE = std::size_t{ 1 } << 16;
+
+	class BlockWriter
+	{
+	private:
+		std::ofstream& _file;
+		std::vector<char> _block;
+		std::size_t _used = 0;
+
+	public:
+		explicit BlockWriter(std::ofstream& file) noexcept
+			: _file{ file }, _block(BLOCK_SIZE)
+		{
+		}
+
+		~BlockWriter(void) noexcept
+		{
+			flush();
+		}
+
+	public:
+		// room for the next few bytes, which the caller fills in place
+		char* reserve(std::size_t bytes) noexcept
+		{
+			if (_used + bytes > _block.size())
+			{
+				flush();
+			}
+
+			const auto out = _block.data() + _used;
+			_used += bytes;
+
+			return out;
+		}
+
+		void flush(void) noexcept
+		{
+			_file.write(_block.data(), static_cast<std::streamsize>(_used));
+			_used = 0;
+		}
+	};
+
+	bool write_file(const std::string& filepath, const std::vector<std::uint8_t>& bytes) noexcept
+	{
+		std::ofstream file(filepath, std::ios::out | std::ios::binary);
+		file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+		if (!file)
+		{
+			luma::log(std::format("error writing to file `{}`", filepath));
+			return false;
+		}
+
+		return true;
+	}
+}
+
 namespace luma
 {
 	Image::Image(std::int32_t width, std::int32_t height, bool allocate) noexcept
-		: _width{ width }, _height{ height }
+		: _width{ width }, _height{ height }, _data{ nullptr }, _owned{ allocate }
 	{
 		if (allocate)
 		{
 			_data = new std::uint32_t[width * height];
 		}
+	}
 
-		else
+	Image::~Image(void) noexcept
+	{
+		if (_owned)
 		{
-			_data = nullptr;
+			delete[] _data;
 		}
 	}
 
 	void Image::shadow_from(std::uint32_t* data) noexcept
 	{
+		if (_owned)
+		{
+			delete[] _data;
+			_owned = false;
+		}
+
 		_data = data;
 	}
 
-	void Image::export_to_ppm(const std::string& filepath) noexcept
+	bool Image::export_to(const std::string& filepath) noexcept
+	{
+		auto extension = std::filesystem::path(filepath).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+		if (extension == ".ppm") return export_to_ppm(filepath);
+		if (extension == ".bmp") return export_to_bmp(filepath);
+		if (extension == ".qoi") return export_to_qoi(filepath);
+		if (extension == ".png") return export_to_png(filepath);
+
+		log(std::format("unrecognized image format `{}`", extension));
+		return false;
+	}
+
+	bool Image::export_to_ppm(const std::string& filepath) noexcept
 	{
+		std::ofstream file(filepath, std::ios::out | std::ios::binary);
+
+		if (!file)
+		{
+			log(std::format("error writing to file `{}`", filepath));
+			return false;
+		}
+
 		// portable pixmap header
-		auto ppm = std::format("P3\n{} {}\n255\n", _width, _height);
+		const auto header = std::format("P6\n{} {}\n255\n", _width, _height);
+		file.write(header.data(), static_cast<std::streamsize>(header.size()));
 
-		for (auto x = 0; x < _width; x++)
 		{
+			::BlockWriter writer{ file };
+
 			for (auto y = 0; y < _height; y++)
 			{
-				const auto coordinate = y * _width + x;
-				const auto data = _data[coordinate];
-
-				const auto red = (data & 0xFF0000) >> 16;
-				const auto green = (data & 0xFF00) >> 8;
-				const auto blue = (data & 0xFF) >> 00;
+				for (auto x = 0; x < _width; x++)
+				{
+					const auto data = _data[y * _width + x];
+					const auto out = writer.reserve(3);
 
-				ppm += std::format("{} {} {}  ", red, green, blue);
+					out[0] = static_cast<char>((data >> 16) & 0xFF);
+					out[1] = static_cast<char>((data >> 8) & 0xFF);
+					out[2] = static_cast<char>(data & 0xFF);
+				}
 			}
+		}
 
-			ppm += '\n';
+		if (!file)
+		{
+			log(std::format("error writing to file `{}`", filepath));
+			return false;
 		}
 
-		if (std::ofstream file(filepath); file.good())
+		return true;
+	}
+
+	bool Image::export_to_qoi(const std::string& filepath) noexcept
+	{
+		return ::write_file(filepath, encode_qoi(_data, _width, _height));
+	}
+
+	bool Image::export_to_png(const std::string& filepath) noexcept
+	{
+		return ::write_file(filepath, encode_png(_data, _width, _height));
+	}
+
+	bool Image::export_to_pfm(const std::string& filepath, const fx::vec3* colors, float scale) const noexcept
+	{
+		std::ofstream file(filepath, std::ios::out | std::ios::binary);
+
+		if (!file)
 		{
-			file.write(ppm.data(), ppm.size());
+			log(std::format("error writing to file `{}`", filepath));
+			return false;
+		}
 
-			delete[] _data;
-			_data = nullptr;
+		// the sign of the header's scale gives the byte order of the floats that follow
+		const auto order = std::endian::native == std::endian::little ? "-1.0" : "1.0";
+		const auto header = std::format("PF\n{} {}\n{}\n", _width, _height, order);
+		file.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+		{
+			::BlockWriter writer{ file };
+
+			// float maps store the bottom row first
+			for (auto y = _height - 1; y >= 0; y--)
+			{
+				for (auto x = 0; x < _width; x++)
+				{
+					const auto& color = colors[y * _width + x];
+					const float channels[3]{ color[0] * scale, color[1] * scale, color[2] * scale };
+
+					std::memcpy(writer.reserve(sizeof(channels)), channels, sizeof(channels));
+				}
+			}
 		}
 
-		else
+		if (!file)
 		{
 			log(std::format("error writing to file `{}`", filepath));
+			return false;
 		}
+
+		return true;
 	}
 
-	void Image::export_to_bmp(const std::string& filepath) noexcept
+	bool Image::export_to_bmp(const std::string& filepath) noexcept
 	{
 		static constexpr int FILE_HEADER_SIZE = 14;
 		static constexpr int INFO_HEADER_SIZE = 40;
@@ -122,33 +261,38 @@ namespace luma
 		if (!file)
 		{
 			log(std::format("error writing to file `{}`", filepath));
-			return;
+			return false;
 		}
 
 		file.write(reinterpret_cast<char*>(file_header), FILE_HEADER_SIZE);
 		file.write(reinterpret_cast<char*>(info_header), INFO_HEADER_SIZE);
 
-		std::vector<unsigned char> padding(padding_size, 0);
-
-		// store pixels bottom-up for BMP
-		for (int y = _height - 1; y >= 0; --y)
 		{
-			for (int x = 0; x < _width; ++x)
+			::BlockWriter writer{ file };
+
+			// store pixels bottom-up for BMP
+			for (int y = _height - 1; y >= 0; --y)
 			{
-				const auto data = _data[y * _width + x];
-				unsigned char blue = data & 0xFF;
-				unsigned char green = (data >> 8) & 0xFF;
-				unsigned char red = (data >> 16) & 0xFF;
-
-				file.put(blue);
-				file.put(green);
-				file.put(red);
+				for (int x = 0; x < _width; ++x)
+				{
+					const auto data = _data[y * _width + x];
+					const auto out = writer.reserve(BYTES_PER_PIXEL);
+
+					out[0] = static_cast<char>(data & 0xFF);
+					out[1] = static_cast<char>((data >> 8) & 0xFF);
+					out[2] = static_cast<char>((data >> 16) & 0xFF);
+				}
+
+				std::fill_n(writer.reserve(padding_size), padding_size, '\0');
 			}
+		}
 
-			file.write(reinterpret_cast<char*>(padding.data()), padding_size);
+		if (!file)
+		{
+			log(std::format("error writing to file `{}`", filepath));
+			return false;
 		}
 
-		delete[] _data;
-		_data = nullptr;
+		return true;
 	}
 }
@@ -1,6 +1,8 @@
 #ifndef LUMA_IMAGE_H
 #define LUMA_IMAGE_H
 
+#include "flux/types.h"
+
 // image.h
 // (c) 2025 Connor J. Link. All Rights Reserved.
 
@@ -10,15 +12,32 @@ namespace luma
 	{
 	private:
 		const std::int32_t _width, _height;
+		// 0x00RRGGBB pixels, top row first; only freed here when the image allocated them itself
 		std::uint32_t* _data;
+		bool _owned;
 
 	public:
 		Image(std::int32_t, std::int32_t, bool) noexcept;
+		~Image(void) noexcept;
+
+		Image(const Image&) = delete;
+		Image& operator=(const Image&) = delete;
 
 	public:
+		// views a buffer owned elsewhere, which has to outlive the exports made from it
 		void shadow_from(std::uint32_t*) noexcept;
-		void export_to_ppm(const std::string&) noexcept;
-		void export_to_bmp(const std::string&) noexcept;
+
+		// picks the format from the file's extension: .ppm, .bmp, .qoi or .png
+		bool export_to(const std::string&) noexcept;
+
+		// binary 8-bit portable pixmap (P6)
+		bool export_to_ppm(const std::string&) noexcept;
+		bool export_to_bmp(const std::string&) noexcept;
+		bool export_to_qoi(const std::string&) noexcept;
+		bool export_to_png(const std::string&) noexcept;
+		// portable float map of linear radiance rather than the packed pixels, each color multiplied by
+		// the scale first, which turns an accumulation buffer's sums into means
+		bool export_to_pfm(const std::string&, const fx::vec3*, float) const noexcept;
 	};
 }
 
@@ -0,0 +1,170 @@
+import std;
+
+#include "flux/vector.h"
+#include "irradiance.h"
+#include "geometry.h"
+
+// irradiance.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	// points this far behind a record, relative to its radius, see light it did not (ward's divergence test)
+	constexpr auto BEHIND = .05f;
+
+	std::array<std::int32_t, 3> cell(const fx::vec3& pos) noexcept
+	{
+		return
+		{
+			static_cast<std::int32_t>(std::floor(pos[0] / luma::IrradianceCache::CELL_SIZE)),
+			static_cast<std::int32_t>(std::floor(pos[1] / luma::IrradianceCache::CELL_SIZE)),
+			static_cast<std::int32_t>(std::floor(pos[2] / luma::IrradianceCache::CELL_SIZE)),
+		};
+	}
+
+	std::uint32_t hash(const std::array<std::int32_t, 3>& cell) noexcept
+	{
+		return luma::cell_hash(cell) % luma::IrradianceCache::TABLE_SIZE;
+	}
+}
+
+namespace luma
+{
+	IrradianceCache::IrradianceCache(IrradianceCache&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	IrradianceCache& IrradianceCache::operator=(IrradianceCache&& other) noexcept
+	{
+		if (this == &other)
+		{
+			return *this;
+		}
+
+		_records = std::move(other._records);
+		_links = std::move(other._links);
+		_heads = std::move(other._heads);
+
+		_record_count.store(other._record_count.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+		_link_count.store(other._link_count.exchange(1, std::memory_order_relaxed), std::memory_order_relaxed);
+
+		return *this;
+	}
+
+	void IrradianceCache::reset(void) noexcept
+	{
+		if (_records.empty())
+		{
+			_records.resize(CAPACITY);
+			// records reach at most two cells along each axis
+			_links.resize(8 * CAPACITY + 1);
+			_heads = std::vector<std::atomic<std::uint32_t>>(TABLE_SIZE);
+		}
+
+		for (auto& head : _heads)
+		{
+			head.store(0, std::memory_order_relaxed);
+		}
+
+		_record_count.store(0, std::memory_order_relaxed);
+		_link_count.store(1, std::memory_order_relaxed);
+	}
+
+	bool IrradianceCache::lookup(const fx::vec3& pos, const fx::vec3& normal, fx::vec3& irradiance) const noexcept
+	{
+		if (_heads.empty())
+		{
+			return false;
+		}
+
+		fx::vec3 sum{};
+		auto total = 0.f;
+
+		auto link = _heads[::hash(::cell(pos))].load(std::memory_order_acquire);
+
+		for (; link != 0; link = _links[link].next)
+		{
+			const auto& record = _records[_links[link].record];
+
+			const auto offset = fx::subtract(pos, record.pos);
+			const auto distance = std::sqrt(fx::dot(offset, offset));
+			const auto divergence = std::sqrt(std::max(0.f, 1.f - fx::dot(normal, record.normal)));
+
+			const auto error = distance / record.radius + divergence;
+
+			if (error >= ACCURACY)
+			{
+				continue;
+			}
+
+			const auto average_normal = fx::scale(fx::add(normal, record.normal), .5f);
+
+			if (fx::dot(offset, average_normal) < -BEHIND * record.radius)
+			{
+				continue;
+			}
+
+			// ward's 1 / error weight, offset so that it fades to zero at the edge of the valid region
+			// rather than cutting off, which would leave visible seams between records
+			const auto weight = 1.f / std::max(error, 1e-4f) - 1.f / ACCURACY;
+
+			sum = fx::add(sum, fx::scale(record.irradiance, weight));
+			total += weight;
+		}
+
+		if (total <= 0.f)
+		{
+			return false;
+		}
+
+		irradiance = fx::scale(sum, 1.f / total);
+		return true;
+	}
+
+	void IrradianceCache::insert(const fx::vec3& pos, const fx::vec3& normal, const fx::vec3& irradiance, float radius) noexcept
+	{
+		const auto index = _record_count.fetch_add(1, std::memory_order_relaxed);
+
+		// a full cache keeps serving lookups; new points simply go uncached
+		if (index >= CAPACITY)
+		{
+			return;
+		}
+
+		const auto clamped = std::clamp(radius, MIN_RADIUS, MAX_RADIUS);
+		_records[index] = { pos, normal, irradiance, clamped };
+
+		const auto reach = ACCURACY * clamped;
+		const auto lo = ::cell(fx::subtract(pos, fx::vec3{ reach, reach, reach }));
+		const auto hi = ::cell(fx::add(pos, fx::vec3{ reach, reach, reach }));
+
+		for (auto z = lo[2]; z <= hi[2]; z++)
+		{
+			for (auto y = lo[1]; y <= hi[1]; y++)
+			{
+				for (auto x = lo[0]; x <= hi[0]; x++)
+				{
+					const auto link = _link_count.fetch_add(1, std::memory_order_relaxed);
+
+					if (link >= _links.size())
+					{
+						return;
+					}
+
+					auto& head = _heads[::hash({ x, y, z })];
+
+					_links[link].record = index;
+					auto next = head.load(std::memory_order_relaxed);
+
+					// the release publishes the record and the link together with the new head
+					do
+					{
+						_links[link].next = next;
+					}
+					while (!head.compare_exchange_weak(next, link, std::memory_order_release, std::memory_order_relaxed));
+				}
+			}
+		}
+	}
+}
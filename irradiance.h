@@ -0,0 +1,74 @@
+#ifndef LUMA_IRRADIANCE_H
+#define LUMA_IRRADIANCE_H
+
+#include "flux/types.h"
+
+// irradiance.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	struct IrradianceRecord
+	{
+		fx::vec3 pos, normal;
+		fx::vec3 irradiance;
+		// harmonic mean distance to the surfaces seen from the record, which bounds how far the
+		// irradiance can be extrapolated before nearby geometry changes it
+		float radius;
+	};
+
+	// ward's irradiance cache (ward et al. 1988): diffuse indirect light is sampled with many paths
+	// at sparse points and interpolated everywhere else within each record's validity radius
+	//
+	// records live in a fixed pool indexed by a hashed grid whose cells are as large as the widest
+	// area of influence, so every record that can affect a point is linked into the point's own cell;
+	// records are appended and linked with atomic pushes only, so lookups and insertions from any
+	// number of threads never block one another
+	class IrradianceCache
+	{
+	public:
+		// largest interpolation error accepted, in units of the record radius plus normal divergence
+		static constexpr auto ACCURACY = .25f;
+		static constexpr auto MIN_RADIUS = .05f;
+		static constexpr auto MAX_RADIUS = 4.f;
+		static constexpr auto CELL_SIZE = ACCURACY * MAX_RADIUS;
+
+		static constexpr auto TABLE_SIZE = 1u << 16;
+		static constexpr auto CAPACITY = 1u << 18;
+
+	private:
+		struct Link
+		{
+			std::uint32_t record;
+			std::uint32_t next;
+		};
+
+		std::vector<IrradianceRecord> _records;
+		std::atomic<std::uint32_t> _record_count{ 0 };
+
+		// index zero is never handed out, so a zero head or next marks the end of a cell's list
+		std::vector<Link> _links;
+		std::atomic<std::uint32_t> _link_count{ 1 };
+
+		std::vector<std::atomic<std::uint32_t>> _heads;
+
+	public:
+		IrradianceCache(void) noexcept = default;
+		// the pool's counters are atomic, so moves are spelled out; neither cache may be in use meanwhile
+		IrradianceCache(IrradianceCache&&) noexcept;
+		IrradianceCache& operator=(IrradianceCache&&) noexcept;
+
+	public:
+		// allocates the pool on first use and drops every record; not safe against concurrent use
+		void reset(void) noexcept;
+
+		// weighted blend of the records valid at the point; false when there are none
+		bool lookup(const fx::vec3&, const fx::vec3&, fx::vec3&) const noexcept;
+		void insert(const fx::vec3&, const fx::vec3&, const fx::vec3&, float) noexcept;
+
+	public:
+		std::size_t size(void) const noexcept { return std::min(_record_count.load(std::memory_order_relaxed), CAPACITY); }
+	};
+}
+
+#endif
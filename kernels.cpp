@@ -0,0 +1,153 @@
+import std;
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#include "kernels.h"
+#include "log.h"
+
+// kernels.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	std::array<std::uint32_t, 4> cpuid(std::uint32_t leaf, std::uint32_t subleaf) noexcept
+	{
+#if defined(_MSC_VER)
+		int registers[4]{};
+		__cpuidex(registers, static_cast<int>(leaf), static_cast<int>(subleaf));
+
+		return { static_cast<std::uint32_t>(registers[0]), static_cast<std::uint32_t>(registers[1]), static_cast<std::uint32_t>(registers[2]), static_cast<std::uint32_t>(registers[3]) };
+#else
+		std::uint32_t a = 0, b = 0, c = 0, d = 0;
+		__cpuid_count(leaf, subleaf, a, b, c, d);
+
+		return { a, b, c, d };
+#endif
+	}
+
+	// register state the operating system saves on a context switch
+	std::uint64_t enabled_state(void) noexcept
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		std::uint32_t lo = 0, hi = 0;
+		__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+
+		return (static_cast<std::uint64_t>(hi) << 32) | lo;
+#endif
+	}
+
+	bool bit(std::uint32_t value, std::uint32_t index) noexcept
+	{
+		return ((value >> index) & 1u) != 0;
+	}
+#endif
+
+	// nullptr for variants this build does not contain
+	const luma::Kernels* table(luma::Isa isa) noexcept
+	{
+		using enum luma::Isa;
+		switch (isa)
+		{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+			case SSE2: return &luma::sse2::table;
+			case AVX2: return &luma::avx2::table;
+			case AVX512: return &luma::avx512::table;
+#elif defined(_M_ARM64) || defined(__aarch64__)
+			case NEON: return &luma::neon::table;
+#endif
+			default: return nullptr;
+		}
+	}
+
+	std::atomic<const luma::Kernels*> _selected{ nullptr };
+}
+
+namespace luma
+{
+	Isa detect_isa(void) noexcept
+	{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+		const auto highest = ::cpuid(0, 0)[0];
+		const auto features = ::cpuid(1, 0);
+
+		// without xsave enabled the os does not preserve the vector registers beyond sse
+		if (highest < 7 || !::bit(features[2], 27))
+		{
+			return Isa::SSE2;
+		}
+
+		const auto extended = ::cpuid(7, 0);
+		const auto state = ::enabled_state();
+
+		// xmm and ymm state, then opmask and both halves of the upper zmm state on top
+		const auto ymm = (state & 0x06) == 0x06;
+		const auto zmm = (state & 0xE6) == 0xE6;
+
+		const auto avx2 = ymm && ::bit(features[2], 28) && ::bit(features[2], 12) && ::bit(extended[1], 5);
+
+		// the subsets msvc's /arch:AVX512 assumes: foundation, doubleword/quadword, byte/word and vector length
+		const auto avx512 = avx2 && zmm && ::bit(extended[1], 16) && ::bit(extended[1], 17) && ::bit(extended[1], 30) && ::bit(extended[1], 31);
+
+		return avx512 ? Isa::AVX512 : avx2 ? Isa::AVX2 : Isa::SSE2;
+#elif defined(_M_ARM64) || defined(__aarch64__)
+		return Isa::NEON;
+#else
+		return Isa::AUTO;
+#endif
+	}
+
+	const Kernels* kernel_variant(Isa isa) noexcept
+	{
+		// x86 variants are ordered, so anything up to the detected one runs
+		if (static_cast<int>(isa) > static_cast<int>(detect_isa()))
+		{
+			return nullptr;
+		}
+
+		return ::table(isa);
+	}
+
+	void select_kernels(Isa requested) noexcept
+	{
+		const auto supported = detect_isa();
+		auto isa = requested == Isa::AUTO ? supported : requested;
+
+		if (requested != Isa::AUTO && kernel_variant(isa) == nullptr)
+		{
+			const auto name = std::find_if(_isa_map.begin(), _isa_map.end(), [&](const auto& entry) { return entry.second == isa; })->first;
+			warning(std::format("the {} kernels cannot run on this processor; falling back to the detected ones", name));
+			isa = supported;
+		}
+
+		const auto selected = ::table(isa);
+
+		if (selected == nullptr)
+		{
+			warning("no kernel variant was built for this processor");
+			return;
+		}
+
+		_selected.store(selected, std::memory_order_release);
+		log(std::format("using the {} kernels", selected->name));
+	}
+
+	const Kernels& kernels(void) noexcept
+	{
+		auto selected = _selected.load(std::memory_order_acquire);
+
+		if (selected == nullptr) [[unlikely]]
+		{
+			select_kernels(Isa::AUTO);
+			selected = _selected.load(std::memory_order_acquire);
+		}
+
+		return *selected;
+	}
+}
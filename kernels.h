@@ -0,0 +1,55 @@
+#ifndef LUMA_KERNELS_H
+#define LUMA_KERNELS_H
+
+#include "flux/types.h"
+#include "geometry.h"
+#include "arguments.h"
+#include "bvh.h"
+#include "denoise.h"
+
+// kernels.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// the hot loops that are worth compiling once per instruction set; each kernels_*.cpp builds the
+	// same source in kernels_impl.h with its own compiler flags and exports one of these tables
+	struct Kernels
+	{
+		const char* name;
+
+		Hit (*intersect)(std::span<const WideNode>, std::span<const PackedSphere>, const Ray&, float) noexcept;
+		bool (*occluded)(std::span<const WideNode>, std::span<const PackedSphere>, const Ray&, float) noexcept;
+
+		// one ray per pixel, rows top to bottom
+		void (*generate_rays)(const RayBasis&, std::uint32_t, std::uint32_t, fx::vec3*) noexcept;
+		// colors scaled by the exposure, through the display curve and the srgb table, packed as 0x00RRGGBB
+		void (*tonemap)(const fx::vec3*, std::uint32_t*, std::uint32_t, float, const std::int32_t*) noexcept;
+
+		// columns [begin, end) of one row of a denoising pass, eight at a time, so end - begin has to be a
+		// multiple of eight; every tap of every block must stay inside the row, so the caller filters the
+		// borders itself
+		void (*wavelet)(const WaveletPass&, std::int32_t, std::int32_t, std::int32_t) noexcept;
+		void (*svgf)(const SvgfPass&, std::int32_t, std::int32_t, std::int32_t) noexcept;
+	};
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	namespace sse2 { extern const Kernels table; }
+	namespace avx2 { extern const Kernels table; }
+	namespace avx512 { extern const Kernels table; }
+#elif defined(_M_ARM64) || defined(__aarch64__)
+	namespace neon { extern const Kernels table; }
+#endif
+
+	// widest instruction set both the processor and the operating system support
+	Isa detect_isa(void) noexcept;
+	// the variant for an instruction set, or nullptr when it was not built or cannot run here
+	const Kernels* kernel_variant(Isa) noexcept;
+	// switches every kernel to the requested variant, or to the detected one for AUTO and for
+	// requests the processor cannot run
+	void select_kernels(Isa) noexcept;
+	// the selected variant; selects automatically if nothing was chosen yet
+	const Kernels& kernels(void) noexcept;
+}
+
+#endif
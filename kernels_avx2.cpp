@@ -0,0 +1,12 @@
+import std;
+
+#if !defined(__AVX2__) || defined(__AVX512F__)
+#error "kernels_avx2.cpp must be built with /arch:AVX2"
+#endif
+
+#include "kernels_impl.h"
+
+// kernels_avx2.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+// the avx2 kernel variant: kernels_impl.h built with /arch:AVX2
@@ -0,0 +1,12 @@
+import std;
+
+#if !defined(__AVX512F__)
+#error "kernels_avx512.cpp must be built with /arch:AVX512"
+#endif
+
+#include "kernels_impl.h"
+
+// kernels_avx512.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+// the avx512 kernel variant: kernels_impl.h built with /arch:AVX512
@@ -0,0 +1,574 @@
+// no include guard: each kernels_*.cpp includes this exactly once, under its own compiler flags
+
+#include "flux/types.h"
+#include "color.h"
+#include "kernels.h"
+#include "post.h"
+#include "simd.h"
+
+// kernels_impl.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+// everything here is compiled several times with different instruction sets, so it stays inside a
+// namespace named after the one in use. an inline function every variant shares, such as std::sqrt
+// or std::min, may be emitted out of line and the linker keeps whichever copy it sees first, possibly
+// one encoded for a wider variant than the processor has. the kernels therefore use only simd::
+// operations and the helpers below; the std:: code left is span element access and the vec3
+// subscript, which compile to plain loads and stores under every instruction set
+
+namespace luma::LUMA_SIMD_ISA
+{
+	namespace
+	{
+		// bit tricks for at most eight children, written out instead of std::countr_zero and std::popcount
+		std::uint32_t lowest_bit(std::uint32_t mask) noexcept
+		{
+			auto index = 0u;
+
+			for (; !(mask & 1u); mask >>= 1)
+			{
+				index++;
+			}
+
+			return index;
+		}
+
+		std::uint32_t count_bits(std::uint32_t mask) noexcept
+		{
+			auto count = 0u;
+
+			for (; mask != 0; mask &= mask - 1)
+			{
+				count++;
+			}
+
+			return count;
+		}
+
+		float square_root(float x) noexcept
+		{
+			alignas(32) float lanes[simd::WIDTH];
+			simd::store(lanes, simd::sqrt(simd::broadcast(x)));
+			return lanes[0];
+		}
+
+		// the denoisers' taps reach at most two spacings up or down and are clamped to the image
+		std::int32_t clamp_row(std::int32_t y, std::int32_t height) noexcept
+		{
+			return y < 0 ? 0 : y >= height ? height - 1 : y;
+		}
+
+		simd::float8 absolute(const simd::float8& a) noexcept
+		{
+			return simd::max(a, simd::subtract(simd::broadcast(0.f), a));
+		}
+
+		struct TraversalRay
+		{
+			float pos[3], idir[3];
+			bool negative[3];
+		};
+
+		TraversalRay prepare(const Ray& ray) noexcept
+		{
+			static constexpr auto EPSILON = 1e-20f;
+
+			TraversalRay out{};
+
+			for (auto axis = 0; axis < 3; axis++)
+			{
+				auto dir = ray.dir[axis];
+
+				// avoid 0 * inf when a component is exactly zero; 1 / dir keeps the sign of a negative zero
+				if (-EPSILON < dir && dir < EPSILON)
+				{
+					dir = 1.f / dir < 0 ? -EPSILON : EPSILON;
+				}
+
+				out.pos[axis] = ray.pos[axis];
+				out.idir[axis] = 1.f / dir;
+				out.negative[axis] = dir < 0;
+			}
+
+			return out;
+		}
+
+		// returns a bitmask of the children whose boxes the ray enters before max and writes each entry distance
+		std::uint32_t intersect_children(const WideNode& node, const TraversalRay& ray, float max, float* near) noexcept
+		{
+			auto entry = simd::broadcast(0.f);
+			auto exit = simd::broadcast(max);
+
+			for (auto axis = 0; axis < 3; axis++)
+			{
+				// t = (origin + q * scale - pos) / dir, folded into a single fused multiply-add per bound
+				const auto scale = simd::multiply(simd::exp2i(simd::broadcast(static_cast<float>(node.exponent[axis]))), simd::broadcast(ray.idir[axis]));
+				const auto bias = simd::broadcast((node.origin[axis] - ray.pos[axis]) * ray.idir[axis]);
+
+				const auto near_plane = ray.negative[axis] ? node.hi[axis] : node.lo[axis];
+				const auto far_plane = ray.negative[axis] ? node.lo[axis] : node.hi[axis];
+
+				entry = simd::max(entry, simd::fmadd(simd::load(near_plane), scale, bias));
+				exit = simd::min(exit, simd::fmadd(simd::load(far_plane), scale, bias));
+			}
+
+			simd::store(near, entry);
+
+			return simd::bits(simd::less_equal(entry, exit));
+		}
+
+		// copy of intersect_sphere() from geometry.h, for the reason given above
+		bool hit_sphere(const Ray& ray, const PackedSphere& sphere, float& distance) noexcept
+		{
+			const auto dx = ray.pos[0] - sphere.x;
+			const auto dy = ray.pos[1] - sphere.y;
+			const auto dz = ray.pos[2] - sphere.z;
+
+			const auto a = ray.dir[0] * ray.dir[0] + ray.dir[1] * ray.dir[1] + ray.dir[2] * ray.dir[2];
+			const auto b = 2 * (dx * ray.dir[0] + dy * ray.dir[1] + dz * ray.dir[2]);
+			const auto c = (dx * dx + dy * dy + dz * dz) - (sphere.radius * sphere.radius);
+
+			const auto d = (b * b) - (4 * a * c);
+
+			if (d <= 0) [[likely]]
+			{
+				return false;
+			}
+
+			distance = (-b - square_root(d)) / (2 * a);
+
+			return distance > 0;
+		}
+
+		Hit intersect(std::span<const WideNode> nodes, std::span<const PackedSphere> spheres, const Ray& ray, float max) noexcept
+		{
+			Hit hit{ max, Hit::NONE };
+
+			if (nodes.empty())
+			{
+				return hit;
+			}
+
+			const auto traversal = prepare(ray);
+
+			struct Entry
+			{
+				std::uint32_t node;
+				float distance;
+			};
+
+			Entry stack[BVH::STACK_SIZE];
+			auto top = 0u;
+
+			stack[top++] = { 0, 0.f };
+
+			while (top > 0)
+			{
+				const auto entry = stack[--top];
+
+				// a closer hit was found after this node was pushed
+				if (entry.distance > hit.distance)
+				{
+					continue;
+				}
+
+				const auto& node = nodes[entry.node];
+
+				alignas(32) float near[BVH::WIDTH];
+				auto mask = intersect_children(node, traversal, hit.distance, near);
+
+				// order the surviving children far to near so the nearest is popped first
+				std::uint32_t slots[BVH::WIDTH]{};
+				auto count = 0u;
+
+				while (mask != 0)
+				{
+					const auto slot = lowest_bit(mask);
+					mask &= mask - 1;
+
+					auto i = count++;
+					for (; i > 0 && near[slots[i - 1]] < near[slot]; i--)
+					{
+						slots[i] = slots[i - 1];
+					}
+
+					slots[i] = slot;
+				}
+
+				// leaves are tested nearest first so the closer hit can cull the internal children below
+				for (auto i = count; i > 0; i--)
+				{
+					const auto slot = slots[i - 1];
+
+					if (node.internal_mask & (1u << slot))
+					{
+						continue;
+					}
+
+					const auto first = node.primitive_base + (node.meta[slot] >> 3);
+					const auto last = first + (node.meta[slot] & 0b111);
+
+					for (auto primitive = first; primitive < last; primitive++)
+					{
+						auto distance = 0.f;
+
+						if (hit_sphere(ray, spheres[primitive], distance) && distance < hit.distance)
+						{
+							hit = { distance, primitive };
+						}
+					}
+				}
+
+				for (auto i = 0u; i < count; i++)
+				{
+					const auto slot = slots[i];
+
+					if (!(node.internal_mask & (1u << slot)) || near[slot] > hit.distance)
+					{
+						continue;
+					}
+
+					const auto rank = count_bits(static_cast<std::uint32_t>(node.internal_mask) & ((1u << slot) - 1));
+					stack[top++] = { node.child_base + rank, near[slot] };
+				}
+			}
+
+			return hit;
+		}
+
+		bool occluded(std::span<const WideNode> nodes, std::span<const PackedSphere> spheres, const Ray& ray, float max) noexcept
+		{
+			if (nodes.empty())
+			{
+				return false;
+			}
+
+			const auto traversal = prepare(ray);
+
+			std::uint32_t stack[BVH::STACK_SIZE];
+			auto top = 0u;
+
+			stack[top++] = 0;
+
+			// no ordering is needed since any hit ends the search
+			while (top > 0)
+			{
+				const auto& node = nodes[stack[--top]];
+
+				alignas(32) float near[BVH::WIDTH];
+				auto mask = intersect_children(node, traversal, max, near);
+
+				while (mask != 0)
+				{
+					const auto slot = lowest_bit(mask);
+					mask &= mask - 1;
+
+					if (node.internal_mask & (1u << slot))
+					{
+						const auto rank = count_bits(static_cast<std::uint32_t>(node.internal_mask) & ((1u << slot) - 1));
+						stack[top++] = node.child_base + rank;
+						continue;
+					}
+
+					const auto first = node.primitive_base + (node.meta[slot] >> 3);
+					const auto last = first + (node.meta[slot] & 0b111);
+
+					for (auto primitive = first; primitive < last; primitive++)
+					{
+						auto distance = 0.f;
+
+						if (hit_sphere(ray, spheres[primitive], distance) && distance < max)
+						{
+							return true;
+						}
+					}
+				}
+			}
+
+			return false;
+		}
+
+		void generate_rays(const RayBasis& basis, std::uint32_t width, std::uint32_t height, fx::vec3* rays) noexcept
+		{
+			const simd::vec3x8 axes[3]
+			{
+				simd::broadcast(basis.axes[0]),
+				simd::broadcast(basis.axes[1]),
+				simd::broadcast(basis.axes[2]),
+			};
+
+			alignas(32) static constexpr float lanes[simd::WIDTH]{ 0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f };
+
+			// renormalization of pixel coordinates to [-1, 1)
+			const auto step = simd::broadcast(2.f / width);
+			const auto minus_one = simd::broadcast(-1.f);
+
+			for (auto y = 0u; y < height; y++)
+			{
+				const auto v = 2.f * static_cast<float>(y) / height - 1.f;
+
+				for (auto x = 0u; x < width; x += simd::WIDTH)
+				{
+					const auto u = simd::fmadd(simd::add(simd::load(lanes), simd::broadcast(static_cast<float>(x))), step, minus_one);
+
+					const auto target = [&](int axis)
+					{
+						return simd::fmadd(u, simd::broadcast(basis.along_x[axis]), simd::broadcast(v * basis.along_y[axis] + basis.center[axis]));
+					};
+
+					const auto scalar = simd::rcp(target(3));
+					const auto corrected = simd::vec3x8{ simd::multiply(target(0), scalar), simd::multiply(target(1), scalar), simd::multiply(target(2), scalar) };
+					const auto normalized = simd::normalize(corrected);
+
+					const auto ray = simd::add(simd::add(simd::scale(axes[0], normalized.x), simd::scale(axes[1], normalized.y)), simd::scale(axes[2], normalized.z));
+
+					simd::store(&rays[y * width + x], ray, width - x < simd::WIDTH ? width - x : simd::WIDTH);
+				}
+			}
+		}
+
+		// channels are independent until they are packed, so the colors are read as a flat run of
+		// floats and eight pixels take three loads with no transposition
+		void tonemap(const fx::vec3* colors, std::uint32_t* packed, std::uint32_t count, float exposure, const std::int32_t* table) noexcept
+		{
+			static_assert(sizeof(fx::vec3) == 3 * sizeof(float));
+
+			const auto scale = simd::broadcast(exposure);
+			const auto top = simd::broadcast(static_cast<float>(SRGB_TABLE_SIZE - 1));
+			const auto half = simd::broadcast(.5f);
+
+			auto block = [&](const float* channels, std::uint32_t* out)
+			{
+				simd::index8 codes[3];
+
+				for (auto i = 0u; i < 3; i++)
+				{
+					const auto display = luma::tonemap(simd::multiply(simd::load(channels + i * simd::WIDTH), scale));
+					codes[i] = simd::gather(table, simd::truncate(simd::fmadd(display, top, half)));
+				}
+
+				simd::pack_rgb(out, codes[0], codes[1], codes[2]);
+			};
+
+			auto i = 0u;
+
+			for (; i + simd::WIDTH <= count; i += simd::WIDTH)
+			{
+				block(reinterpret_cast<const float*>(colors + i), packed + i);
+			}
+
+			if (i < count)
+			{
+				// the last few pixels go through a zero-padded block; plain loops rather than std::copy,
+				// whose instantiations every variant would share
+				float rest[3 * simd::WIDTH]{};
+				std::uint32_t out[simd::WIDTH];
+
+				for (auto j = i; j < count; j++)
+				{
+					for (auto channel = 0u; channel < 3; channel++)
+					{
+						rest[3 * (j - i) + channel] = colors[j][channel];
+					}
+				}
+
+				block(rest, out);
+
+				for (auto j = i; j < count; j++)
+				{
+					packed[j] = out[j - i];
+				}
+			}
+		}
+
+		// the vector half of Denoiser::pass(); the scalar filter in denoise.cpp computes the same thing
+		void wavelet(const WaveletPass& pass, std::int32_t y, std::int32_t begin, std::int32_t end) noexcept
+		{
+			const auto zero = simd::broadcast(0.f);
+			const auto one = simd::broadcast(1.f);
+			const auto ceiling = simd::broadcast(FILTER_MAX_EXPONENT);
+			const auto color_scale = simd::broadcast(pass.color_weight);
+			const auto normal_scale = simd::broadcast(pass.normal_weight);
+			const auto albedo_scale = simd::broadcast(pass.albedo_weight);
+
+			for (auto x = begin; x < end; x += static_cast<std::int32_t>(simd::WIDTH))
+			{
+				const auto p = y * pass.width + x;
+
+				simd::float8 color[3], normal[3], albedo[3];
+
+				for (auto k = 0; k < 3; k++)
+				{
+					color[k] = simd::load(pass.colors[k] + p);
+					normal[k] = simd::load(pass.normals[k] + p);
+					albedo[k] = simd::load(pass.albedos[k] + p);
+				}
+
+				const auto depth = simd::load(pass.depths + p);
+				const auto inverse_depth = simd::divide(simd::broadcast(pass.depth_weight), simd::max(depth, simd::broadcast(FILTER_MIN_DEPTH)));
+
+				simd::float8 sum[3]{ zero, zero, zero };
+				auto total = zero;
+
+				for (auto j = 0; j < 5; j++)
+				{
+					const auto row = clamp_row(y + (j - 2) * pass.spacing, pass.height) * pass.width;
+
+					for (auto i = 0; i < 5; i++)
+					{
+						const auto q = row + x + (i - 2) * pass.spacing;
+
+						simd::float8 tap[3];
+
+						auto color_distance = zero, normal_distance = zero, albedo_distance = zero;
+
+						for (auto k = 0; k < 3; k++)
+						{
+							tap[k] = simd::load(pass.colors[k] + q);
+
+							const auto dc = simd::subtract(tap[k], color[k]);
+							const auto dn = simd::subtract(simd::load(pass.normals[k] + q), normal[k]);
+							const auto da = simd::subtract(simd::load(pass.albedos[k] + q), albedo[k]);
+
+							color_distance = simd::fmadd(dc, dc, color_distance);
+							normal_distance = simd::fmadd(dn, dn, normal_distance);
+							albedo_distance = simd::fmadd(da, da, albedo_distance);
+						}
+
+						const auto depth_distance = absolute(simd::subtract(simd::load(pass.depths + q), depth));
+
+						auto exponent = simd::multiply(color_distance, color_scale);
+						exponent = simd::fmadd(normal_distance, normal_scale, exponent);
+						exponent = simd::fmadd(albedo_distance, albedo_scale, exponent);
+						exponent = simd::min(simd::fmadd(depth_distance, inverse_depth, exponent), ceiling);
+
+						const auto weight = simd::multiply(simd::broadcast(WAVELET_TAPS[i] * WAVELET_TAPS[j]), simd::exp(simd::subtract(zero, exponent)));
+
+						for (auto k = 0; k < 3; k++)
+						{
+							sum[k] = simd::fmadd(weight, tap[k], sum[k]);
+						}
+
+						total = simd::add(total, weight);
+					}
+				}
+
+				const auto inverse_total = simd::divide(one, total);
+
+				for (auto k = 0; k < 3; k++)
+				{
+					simd::store(pass.filtered[k] + p, simd::multiply(sum[k], inverse_total));
+				}
+			}
+		}
+
+		// the vector half of Svgf::pass()
+		void svgf(const SvgfPass& pass, std::int32_t y, std::int32_t begin, std::int32_t end) noexcept
+		{
+			const auto zero = simd::broadcast(0.f);
+			const auto one = simd::broadcast(1.f);
+			const auto ceiling = simd::broadcast(FILTER_MAX_EXPONENT);
+			const auto albedo_scale = simd::broadcast(pass.albedo_weight);
+
+			for (auto x = begin; x < end; x += static_cast<std::int32_t>(simd::WIDTH))
+			{
+				const auto p = y * pass.width + x;
+
+				simd::float8 normal[4], albedo[3];
+
+				for (auto k = 0; k < 4; k++)
+				{
+					normal[k] = simd::load(pass.normals[k] + p);
+				}
+
+				for (auto k = 0; k < 3; k++)
+				{
+					albedo[k] = simd::load(pass.albedos[k] + p);
+				}
+
+				const auto luminance = simd::load(pass.luminances + p);
+				const auto luminance_scale = simd::load(pass.luminance_scales + p);
+				const auto depth = simd::load(pass.depths + p);
+				const auto inverse_depth = simd::divide(simd::broadcast(pass.depth_weight), simd::max(depth, simd::broadcast(FILTER_MIN_DEPTH)));
+
+				simd::float8 sum[3]{ zero, zero, zero };
+				auto sum_variance = zero, total = zero;
+
+				for (auto j = 0; j < 3; j++)
+				{
+					const auto row = clamp_row(y + (j - 1) * pass.spacing, pass.height) * pass.width;
+
+					for (auto i = 0; i < 3; i++)
+					{
+						const auto q = row + x + (i - 1) * pass.spacing;
+
+						auto facing = zero;
+
+						for (auto k = 0; k < 4; k++)
+						{
+							facing = simd::fmadd(normal[k], simd::load(pass.normals[k] + q), facing);
+						}
+
+						facing = simd::max(facing, zero);
+
+						for (auto n = 0; n < SVGF_NORMAL_SQUARINGS; n++)
+						{
+							facing = simd::multiply(facing, facing);
+						}
+
+						auto albedo_distance = zero;
+
+						for (auto k = 0; k < 3; k++)
+						{
+							const auto da = simd::subtract(simd::load(pass.albedos[k] + q), albedo[k]);
+							albedo_distance = simd::fmadd(da, da, albedo_distance);
+						}
+
+						auto exponent = simd::multiply(absolute(simd::subtract(luminance, simd::load(pass.luminances + q))), luminance_scale);
+						exponent = simd::fmadd(absolute(simd::subtract(depth, simd::load(pass.depths + q))), inverse_depth, exponent);
+						exponent = simd::fmadd(albedo_distance, albedo_scale, exponent);
+						exponent = simd::min(exponent, ceiling);
+
+						const auto weight = simd::multiply(simd::multiply(simd::broadcast(SVGF_TAPS[i] * SVGF_TAPS[j]), facing), simd::exp(simd::subtract(zero, exponent)));
+
+						for (auto k = 0; k < 3; k++)
+						{
+							sum[k] = simd::fmadd(weight, simd::load(pass.colors[k] + q), sum[k]);
+						}
+
+						sum_variance = simd::fmadd(simd::multiply(weight, weight), simd::load(pass.variances + q), sum_variance);
+						total = simd::add(total, weight);
+					}
+				}
+
+				const auto inverse_total = simd::divide(one, total);
+
+				simd::float8 out[3];
+
+				for (auto k = 0; k < 3; k++)
+				{
+					out[k] = simd::multiply(sum[k], inverse_total);
+					simd::store(pass.filtered[k] + p, out[k]);
+				}
+
+				auto out_luminance = simd::multiply(out[0], simd::broadcast(LUMINANCE_RED));
+				out_luminance = simd::fmadd(out[1], simd::broadcast(LUMINANCE_GREEN), out_luminance);
+				out_luminance = simd::fmadd(out[2], simd::broadcast(LUMINANCE_BLUE), out_luminance);
+
+				simd::store(pass.filtered_luminances + p, out_luminance);
+				simd::store(pass.filtered_variances + p, simd::multiply(sum_variance, simd::multiply(inverse_total, inverse_total)));
+			}
+		}
+	}
+
+	const Kernels table
+	{
+		simd::backend(),
+		&intersect,
+		&occluded,
+		&generate_rays,
+		&tonemap,
+		&wavelet,
+		&svgf,
+	};
+}
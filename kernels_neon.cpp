@@ -0,0 +1,12 @@
+import std;
+
+#if !(defined(_M_ARM64) || defined(__aarch64__))
+#error "kernels_neon.cpp is only built for arm64"
+#endif
+
+#include "kernels_impl.h"
+
+// kernels_neon.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+// the neon kernel variant: kernels_impl.h built for arm64, where neon is always present
@@ -0,0 +1,12 @@
+import std;
+
+#if defined(__AVX2__) || !(defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#error "kernels_sse2.cpp must be built for x86 without /arch:AVX2"
+#endif
+
+#include "kernels_impl.h"
+
+// kernels_sse2.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+// the sse2 kernel variant: kernels_impl.h built with /arch:SSE2, the x64 baseline
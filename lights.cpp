@@ -0,0 +1,377 @@
+import std;
+
+#include "flux/vector.h"
+#include "lights.h"
+#include "color.h"
+#include "sampler.h"
+
+// lights.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	float angle_between(const fx::vec3& a, const fx::vec3& b) noexcept
+	{
+		return std::acos(std::clamp(fx::dot(a, b), -1.f, 1.f));
+	}
+
+	// smallest cone containing both (pbrt's DirectionCone::Union)
+	void merge_cones(luma::LightBounds& into, const luma::LightBounds& other) noexcept
+	{
+		const auto theta_e = std::max(into.theta_e, other.theta_e);
+
+		if (into.theta_o >= fx::pi() || other.theta_o >= fx::pi())
+		{
+			into.theta_o = fx::pi();
+			into.theta_e = theta_e;
+			return;
+		}
+
+		auto a = into;
+		auto b = other;
+
+		if (b.theta_o > a.theta_o)
+		{
+			std::swap(a, b);
+		}
+
+		const auto theta_d = ::angle_between(a.axis, b.axis);
+
+		// b already lies within a
+		if (std::min(theta_d + b.theta_o, fx::pi()) <= a.theta_o)
+		{
+			into.axis = a.axis;
+			into.theta_o = a.theta_o;
+			into.theta_e = theta_e;
+			return;
+		}
+
+		const auto theta_o = .5f * (a.theta_o + theta_d + b.theta_o);
+		const auto rotation = fx::cross(a.axis, b.axis);
+		const auto rotation_length = std::sqrt(fx::dot(rotation, rotation));
+
+		if (theta_o >= fx::pi() || rotation_length < 1e-6f)
+		{
+			into.theta_o = fx::pi();
+			into.theta_e = theta_e;
+			return;
+		}
+
+		// rotate a's axis towards b's far enough to cover both
+		const auto theta_r = theta_o - a.theta_o;
+		const auto k = fx::scale(rotation, 1.f / rotation_length);
+		const auto axis = fx::add(fx::scale(a.axis, std::cos(theta_r)), fx::scale(fx::cross(k, a.axis), std::sin(theta_r)));
+
+		into.axis = fx::normalize(axis);
+		into.theta_o = theta_o;
+		into.theta_e = theta_e;
+	}
+
+	luma::LightBounds merge(const luma::LightBounds& a, const luma::LightBounds& b) noexcept
+	{
+		auto bounds = a;
+
+		for (auto axis = 0; axis < 3; axis++)
+		{
+			bounds.min[axis] = std::min(a.min[axis], b.min[axis]);
+			bounds.max[axis] = std::max(a.max[axis], b.max[axis]);
+		}
+
+		bounds.power = a.power + b.power;
+		::merge_cones(bounds, b);
+
+		return bounds;
+	}
+
+	luma::LightBounds bound(const luma::Emitter& emitter) noexcept
+	{
+		const auto extent = fx::vec3{ emitter.radius, emitter.radius, emitter.radius };
+
+		// a lambertian sphere emits L * pi per unit area, over 4 pi r^2 of area
+		const auto area = 4.f * fx::pi() * emitter.radius * emitter.radius;
+		const auto power = fx::pi() * area * luma::luminance(emitter.emission);
+
+		// sphere normals point everywhere, each emitting into a full hemisphere
+		return { fx::subtract(emitter.center, extent), fx::add(emitter.center, extent), { 0.f, 0.f, 1.f }, fx::pi(), .5f * fx::pi(), power };
+	}
+
+	// conservative estimate of how much the emitters within the bounds can contribute to a point with
+	// the given normal: power over squared distance, with both cosines bounded by the angular extent
+	// of the box as seen from the point
+	float importance(const luma::LightBounds& bounds, const fx::vec3& pos, const fx::vec3& normal) noexcept
+	{
+		if (bounds.power <= 0.f)
+		{
+			return 0.f;
+		}
+
+		const auto center = fx::scale(fx::add(bounds.min, bounds.max), .5f);
+		const auto to = fx::subtract(center, pos);
+		const auto extent = fx::subtract(bounds.max, bounds.min);
+
+		const auto radius2 = .25f * fx::dot(extent, extent);
+		const auto distance2 = fx::dot(to, to);
+
+		// inside the bounds light can arrive from any direction; the radius also keeps the estimate
+		// finite for clusters much larger than their distance
+		if (distance2 <= radius2)
+		{
+			return bounds.power / std::max(radius2, 1e-8f);
+		}
+
+		const auto distance = std::sqrt(distance2);
+		const auto dir = fx::scale(to, 1.f / distance);
+
+		const auto sin_u2 = radius2 / distance2;
+		const auto sin_u = std::sqrt(sin_u2);
+		const auto cos_u = std::sqrt(1.f - sin_u2);
+
+		// receiver: the best cosine any point of the box can make with the normal
+		const auto cos_i = fx::dot(normal, dir);
+		auto bounded_cos_i = 1.f;
+
+		if (cos_i < cos_u)
+		{
+			const auto sin_i = std::sqrt(std::max(0.f, 1.f - cos_i * cos_i));
+			bounded_cos_i = cos_i * cos_u + sin_i * sin_u;
+		}
+
+		if (bounded_cos_i <= 0.f)
+		{
+			return 0.f;
+		}
+
+		// emitter: the smallest angle between any emitter normal in the cone and the direction back to the point
+		auto bounded_cos_e = 1.f;
+
+		if (bounds.theta_o < fx::pi())
+		{
+			const auto theta = ::angle_between(bounds.axis, fx::invert(dir));
+			const auto theta_bounded = std::max(0.f, theta - bounds.theta_o - std::asin(std::min(sin_u, 1.f)));
+
+			if (theta_bounded >= bounds.theta_e)
+			{
+				return 0.f;
+			}
+
+			bounded_cos_e = std::cos(theta_bounded);
+		}
+
+		return bounds.power * bounded_cos_i * bounded_cos_e / distance2;
+	}
+}
+
+namespace luma
+{
+	std::uint32_t LightTree::build(std::uint32_t first, std::uint32_t count) noexcept
+	{
+		const auto index = static_cast<std::uint32_t>(_nodes.size());
+		_nodes.emplace_back();
+
+		if (count == 1)
+		{
+			_nodes[index] = { ::bound(_emitters[first]), first, true };
+			return index;
+		}
+
+		fx::vec3 lo{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+		fx::vec3 hi{ std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+		for (auto i = first; i < first + count; i++)
+		{
+			for (auto axis = 0; axis < 3; axis++)
+			{
+				lo[axis] = std::min(lo[axis], _emitters[i].center[axis]);
+				hi[axis] = std::max(hi[axis], _emitters[i].center[axis]);
+			}
+		}
+
+		auto axis = 0;
+		for (auto i = 1; i < 3; i++)
+		{
+			if (hi[i] - lo[i] > hi[axis] - lo[axis])
+			{
+				axis = i;
+			}
+		}
+
+		// median split along the widest axis keeps the tree balanced, so picking stays logarithmic
+		const auto begin = _emitters.begin() + first;
+		const auto middle = begin + count / 2;
+
+		std::nth_element(begin, middle, begin + count, [axis](const Emitter& lhs, const Emitter& rhs)
+		{
+			return lhs.center[axis] < rhs.center[axis];
+		});
+
+		build(first, count / 2);
+		const auto right = build(first + count / 2, count - count / 2);
+
+		_nodes[index] = { ::merge(_nodes[index + 1].bounds, _nodes[right].bounds), right, false };
+		return index;
+	}
+
+	void LightTree::build(const Scene& scene) noexcept
+	{
+		_nodes.clear();
+		_emitters.clear();
+		_power.clear();
+
+		// nothing emits unless some material does, which spares mapped particle files a pass over every sphere
+		if (std::ranges::none_of(scene.materials, [](const Material& material) { return luminance(material.emission) > 0.f; }))
+		{
+			return;
+		}
+
+		const auto spheres = scene.spheres();
+
+		for (auto i = 0u; i < spheres.size(); i++)
+		{
+			const auto& emission = scene.material(i).emission;
+
+			if (luminance(emission) > 0.f)
+			{
+				const auto& sphere = spheres[i];
+				_emitters.push_back({ { sphere.x, sphere.y, sphere.z }, sphere.radius, emission, i });
+
+				// radiance over the sphere's area; the constant 4 pi^2 is common to every emitter
+				const auto power = luminance(emission) * sphere.radius * sphere.radius;
+				_power.push_back((_power.empty() ? 0.f : _power.back()) + power);
+			}
+		}
+
+		if (!_emitters.empty())
+		{
+			_nodes.reserve(2 * _emitters.size() - 1);
+			build(0, static_cast<std::uint32_t>(_emitters.size()));
+		}
+	}
+
+	bool LightTree::pick(const fx::vec3& pos, const fx::vec3& normal, float u, std::uint32_t& emitter, float& pmf) const noexcept
+	{
+		if (_nodes.empty())
+		{
+			return false;
+		}
+
+		auto node = 0u;
+		pmf = 1.f;
+
+		while (!_nodes[node].leaf)
+		{
+			const auto left = node + 1;
+			const auto right = _nodes[node].offset;
+
+			const auto left_importance = ::importance(_nodes[left].bounds, pos, normal);
+			const auto right_importance = ::importance(_nodes[right].bounds, pos, normal);
+
+			if (left_importance + right_importance <= 0.f)
+			{
+				return false;
+			}
+
+			const auto p = left_importance / (left_importance + right_importance);
+
+			// reuse the sample for the next level by rescaling it within the chosen interval
+			if (u < p)
+			{
+				node = left;
+				u = std::min(u / p, ONE_MINUS_EPSILON);
+				pmf *= p;
+			}
+
+			else
+			{
+				node = right;
+				u = std::min((u - p) / (1.f - p), ONE_MINUS_EPSILON);
+				pmf *= 1.f - p;
+			}
+		}
+
+		if (::importance(_nodes[node].bounds, pos, normal) <= 0.f)
+		{
+			return false;
+		}
+
+		emitter = _nodes[node].offset;
+		return true;
+	}
+
+	bool LightTree::sample(const fx::vec3& pos, const fx::vec3& normal, float u, const fx::vec2& uv, LightSample& sample) const noexcept
+	{
+		auto index = 0u;
+		auto pmf = 0.f;
+
+		if (!pick(pos, normal, u, index, pmf))
+		{
+			return false;
+		}
+
+		const auto& emitter = _emitters[index];
+
+		const auto to = fx::subtract(emitter.center, pos);
+		const auto distance2 = fx::dot(to, to);
+		const auto radius2 = emitter.radius * emitter.radius;
+
+		if (distance2 <= radius2)
+		{
+			return false;
+		}
+
+		const auto distance = std::sqrt(distance2);
+		const auto w = fx::scale(to, 1.f / distance);
+
+		// cone of directions that hit the sphere
+		const auto one_minus_cos_max = cone_extent(emitter.radius, distance);
+
+		const auto one_minus_cos = uv[0] * one_minus_cos_max;
+		const auto cos_theta = 1.f - one_minus_cos;
+		const auto sin_theta = std::sqrt(std::max(0.f, one_minus_cos * (2.f - one_minus_cos)));
+		const auto phi = 2.f * fx::pi() * uv[1];
+
+		fx::vec3 tangent{}, bitangent{};
+		orthonormal_basis(w, tangent, bitangent);
+
+		const auto dir = fx::add(fx::add(fx::scale(tangent, sin_theta * std::cos(phi)), fx::scale(bitangent, sin_theta * std::sin(phi))), fx::scale(w, cos_theta));
+
+		// nearer intersection of the sampled direction with the sphere
+		const auto along = distance * cos_theta;
+		const auto across2 = distance2 - along * along;
+
+		sample.emitter = index;
+		sample.primitive = emitter.primitive;
+		sample.dir = dir;
+		sample.distance = along - std::sqrt(std::max(0.f, radius2 - across2));
+		sample.normal = fx::normalize(fx::subtract(fx::add(pos, fx::scale(dir, sample.distance)), emitter.center));
+		sample.radiance = emitter.emission;
+		sample.pdf = pmf / (2.f * fx::pi() * one_minus_cos_max);
+
+		return true;
+	}
+
+	bool LightTree::emit(float u, const fx::vec2& point, const fx::vec2& direction, LightEmission& emission) const noexcept
+	{
+		if (_emitters.empty())
+		{
+			return false;
+		}
+
+		const auto total = _power.back();
+		const auto found = std::upper_bound(_power.begin(), _power.end(), u * total);
+		const auto index = static_cast<std::size_t>(std::min(found - _power.begin(), static_cast<std::ptrdiff_t>(_power.size() - 1)));
+
+		const auto& emitter = _emitters[index];
+		const auto pmf = (_power[index] - (index > 0 ? _power[index - 1] : 0.f)) / total;
+
+		// uniform point on the sphere, leaving in a direction distributed by the cosine about its normal
+		const auto normal = uniform_sphere(point);
+
+		emission.pos = fx::add(emitter.center, fx::scale(normal, emitter.radius));
+		emission.normal = normal;
+		emission.dir = fx::normalize(fx::add(normal, uniform_sphere(direction)));
+		emission.radiance = emitter.emission;
+		emission.pdf = pmf / (4.f * fx::pi() * emitter.radius * emitter.radius);
+
+		return true;
+	}
+}
@@ -0,0 +1,99 @@
+#ifndef LUMA_LIGHTS_H
+#define LUMA_LIGHTS_H
+
+#include "flux/types.h"
+#include "geometry.h"
+#include "scene.h"
+
+// lights.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// what a light tree node knows about the emitters below it: where they are, how much they emit,
+	// and a cone of emitter normals around axis (half-angle theta_o) each widened by the spread of
+	// emission around the normal (theta_e)
+	struct LightBounds
+	{
+		fx::vec3 min, max;
+		fx::vec3 axis;
+		float theta_o, theta_e;
+		float power;
+	};
+
+	struct LightNode
+	{
+		LightBounds bounds;
+		// interior nodes store their second child here, the first directly follows the node;
+		// leaves store the index of their emitter
+		std::uint32_t offset;
+		bool leaf;
+	};
+
+	// emissive sphere copied out of the scene so that sampling never touches the material table
+	struct Emitter
+	{
+		fx::vec3 center;
+		float radius;
+		fx::vec3 emission;
+		std::uint32_t primitive;
+	};
+
+	struct LightSample
+	{
+		std::uint32_t emitter, primitive;
+		// unit direction towards the sampled point and the distance to it
+		fx::vec3 dir;
+		float distance;
+		// outward normal of the light at the sampled point
+		fx::vec3 normal;
+		fx::vec3 radiance;
+		// solid angle density of dir, including the probability of having picked this light
+		float pdf;
+	};
+
+	// start of a light path: a point on an emitter and a cosine-distributed direction out of it
+	struct LightEmission
+	{
+		fx::vec3 pos, normal, dir;
+		fx::vec3 radiance;
+		// area density of pos, including the probability of having picked this light
+		float pdf;
+	};
+
+	// binary hierarchy over the emissive spheres (conty estevez and kulla 2018); sampling walks down
+	// from the root choosing each child in proportion to a conservative estimate of its contribution
+	// at the shading point, so one light is picked out of n in O(log n) and distant or back-facing
+	// clusters are rarely chosen
+	class LightTree
+	{
+	private:
+		std::vector<LightNode> _nodes;
+		std::vector<Emitter> _emitters;
+		// running sum of each emitter's power, for starting light paths in proportion to it
+		std::vector<float> _power;
+
+	private:
+		std::uint32_t build(std::uint32_t, std::uint32_t) noexcept;
+
+	public:
+		// collects every sphere with an emissive material; must be rebuilt when the scene or its materials change
+		void build(const Scene&) noexcept;
+
+		// picks an emitter with probability proportional to its estimated contribution to the point;
+		// false when no emitter can reach it
+		bool pick(const fx::vec3& pos, const fx::vec3& normal, float, std::uint32_t& emitter, float& pmf) const noexcept;
+		// picks an emitter and samples a direction uniformly within the cone it subtends
+		bool sample(const fx::vec3& pos, const fx::vec3& normal, float, const fx::vec2&, LightSample&) const noexcept;
+		// picks an emitter by power, then a point and a direction to start a light path from
+		bool emit(float, const fx::vec2&, const fx::vec2&, LightEmission&) const noexcept;
+
+	public:
+		std::size_t size(void) const noexcept { return _emitters.size(); }
+		bool empty(void) const noexcept { return _emitters.empty(); }
+
+		const Emitter& emitter(std::uint32_t index) const noexcept { return _emitters[index]; }
+	};
+}
+
+#endif
@@ -16,6 +16,8 @@
 #include "image.h"
 #include "renderer.h"
 #include "gpu.h"
+#include "benchmark.h"
+#include "kernels.h"
 
 #include <windows.h>
 
@@ -45,7 +47,7 @@ class Luma : public olc::PixelGameEngine
 {
 public:
 	Luma()
-		: image{ ScreenWidth(), ScreenHeight(), false }
+		: image{ static_cast<std::int32_t>(luma::_options.width), static_cast<std::int32_t>(luma::_options.height), false }
 	{
 		window_title = "Luma";
 	}
@@ -94,18 +96,60 @@ public:
 
 		if (GetKey(olc::Key::CTRL).bHeld)
 		{
-			if (GetKey(olc::Key::P).bPressed)
+			// frame captures, in the format their extension names
+			const std::pair<olc::Key, const char*> captures[]
 			{
-				image.shadow_from(framebuffer);
-				image.export_to_ppm("luma.ppm");
-				std::println("successfully exported frame capture to `luma.ppm`");
+				{ olc::Key::P, "luma.png" },
+				{ olc::Key::Q, "luma.qoi" },
+				{ olc::Key::B, "luma.bmp" },
+			};
+
+			for (const auto& [key, filepath] : captures)
+			{
+				if (GetKey(key).bPressed)
+				{
+					image.shadow_from(framebuffer);
+
+					if (image.export_to(filepath))
+					{
+						std::println("successfully exported frame capture to `{}`", filepath);
+					}
+				}
 			}
 
-			else if (GetKey(olc::Key::B).bPressed)
+			// the accumulated radiance itself, before exposure and tonemapping
+			if (GetKey(olc::Key::H).bPressed)
 			{
-				image.shadow_from(framebuffer);
-				image.export_to_ppm("luma.bmp");
-				std::println("successfully exported frame capture to `luma.bmp`");
+				if (image.export_to_pfm("luma.pfm", renderer.accumulated_data, 1.f / std::max(renderer.frame_count - 1.f, 1.f)))
+				{
+					std::println("successfully exported radiance capture to `luma.pfm`");
+				}
+			}
+		}
+
+		// look-dev: edits the material under the mouse, which keeps the cached visibility and only restarts the accumulation
+		else if (const auto index = renderer.material_at(static_cast<std::uint32_t>(GetMouseX()), static_cast<std::uint32_t>(GetMouseY())))
+		{
+			auto material = renderer.scene.materials[*index];
+			auto edited = false;
+
+			const auto nudge = [&](olc::Key lower, olc::Key raise, float& value)
+			{
+				if (GetKey(lower).bPressed) { value = std::max(value - .05f, 0.f); edited = true; }
+				if (GetKey(raise).bPressed) { value = std::min(value + .05f, 1.f); edited = true; }
+			};
+
+			for (auto k = 0; k < 3; k++)
+			{
+				nudge(olc::Key::MINUS, olc::Key::EQUALS, material.diffuse[k]);
+			}
+
+			nudge(olc::Key::OEM_4, olc::Key::OEM_6, material.roughness);
+			nudge(olc::Key::COMMA, olc::Key::PERIOD, material.metallic);
+
+			if (edited)
+			{
+				renderer.edit_material(*index, material);
 			}
 		}
 		
@@ -218,6 +262,7 @@ INT APIENTRY wWinMain(
 
 	auto arguments = luma::Arguments{};
 	arguments.parse(args);
+	luma::select_kernels(luma::_options.isa);
 
 	using enum luma::Context;
 	switch (luma::_options.context)
@@ -286,6 +331,11 @@ INT APIENTRY wWinMain(
 
 		} break;
 
+		case BENCHMARK:
+		{
+			luma::benchmark();
+		} break;
+
 		default:
 			break;
 	}
@@ -0,0 +1,158 @@
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mapping.h"
+
+// mapping.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	MappedFile::~MappedFile(void) noexcept
+	{
+		close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+		: _file{ std::exchange(other._file, nullptr) },
+		  _mapping{ std::exchange(other._mapping, nullptr) },
+		  _data{ std::exchange(other._data, nullptr) },
+		  _size{ std::exchange(other._size, 0) }
+	{
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+
+			_file = std::exchange(other._file, nullptr);
+			_mapping = std::exchange(other._mapping, nullptr);
+			_data = std::exchange(other._data, nullptr);
+			_size = std::exchange(other._size, 0);
+		}
+
+		return *this;
+	}
+
+	bool MappedFile::open(const std::string& filepath) noexcept
+	{
+		close();
+
+#if defined(_WIN32)
+		const auto file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER size{};
+
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		const auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (!mapping)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		const auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+		if (!view)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		_file = file;
+		_mapping = mapping;
+		_data = static_cast<const std::byte*>(view);
+		_size = static_cast<std::size_t>(size.QuadPart);
+#else
+		const auto file = ::open(filepath.c_str(), O_RDONLY);
+
+		if (file < 0)
+		{
+			return false;
+		}
+
+		struct stat status{};
+
+		if (fstat(file, &status) != 0 || status.st_size == 0)
+		{
+			::close(file);
+			return false;
+		}
+
+		const auto size = static_cast<std::size_t>(status.st_size);
+		const auto view = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+
+		// the mapping keeps its own reference to the file
+		::close(file);
+
+		if (view == MAP_FAILED)
+		{
+			return false;
+		}
+
+		madvise(view, size, MADV_RANDOM);
+
+		_mapping = view;
+		_data = static_cast<const std::byte*>(view);
+		_size = size;
+#endif
+
+		return true;
+	}
+
+	void MappedFile::close(void) noexcept
+	{
+#if defined(_WIN32)
+		if (_data)
+		{
+			UnmapViewOfFile(_data);
+		}
+
+		if (_mapping)
+		{
+			CloseHandle(_mapping);
+		}
+
+		if (_file)
+		{
+			CloseHandle(_file);
+		}
+#else
+		if (_mapping)
+		{
+			munmap(_mapping, _size);
+		}
+#endif
+
+		_file = nullptr;
+		_mapping = nullptr;
+		_data = nullptr;
+		_size = 0;
+	}
+}
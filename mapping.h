@@ -0,0 +1,39 @@
+#ifndef LUMA_MAPPING_H
+#define LUMA_MAPPING_H
+
+// mapping.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// read-only view of a whole file backed by the operating system's page cache
+	class MappedFile
+	{
+	private:
+		void* _file = nullptr;
+		void* _mapping = nullptr;
+
+		const std::byte* _data = nullptr;
+		std::size_t _size = 0;
+
+	public:
+		MappedFile(void) noexcept = default;
+		~MappedFile(void) noexcept;
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&&) noexcept;
+		MappedFile& operator=(MappedFile&&) noexcept;
+
+	public:
+		bool open(const std::string&) noexcept;
+		void close(void) noexcept;
+
+	public:
+		const std::byte* data(void) const noexcept { return _data; }
+		std::size_t size(void) const noexcept { return _size; }
+	};
+}
+
+#endif
@@ -0,0 +1,325 @@
+import std;
+
+#include "flux/vector.h"
+#include "photons.h"
+#include "color.h"
+#include "log.h"
+
+// photons.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	// photons landing on surfaces facing further away than this are left out of a gather
+	constexpr auto NORMAL_AGREEMENT = .5f;
+
+	// every emitter is paired with every metal, so the pairs are capped for scenes full of both
+	constexpr auto MAX_SOURCES = 1u << 16;
+}
+
+namespace luma
+{
+	std::array<std::int32_t, 3> PhotonMap::cell(const fx::vec3& pos) const noexcept
+	{
+		// cells twice the radius wide put every photon within reach of a point in the 2x2x2 block around it
+		const auto inverse = 1.f / (2.f * _radius);
+
+		return
+		{
+			static_cast<std::int32_t>(std::floor(pos[0] * inverse)),
+			static_cast<std::int32_t>(std::floor(pos[1] * inverse)),
+			static_cast<std::int32_t>(std::floor(pos[2] * inverse)),
+		};
+	}
+
+	std::uint32_t PhotonMap::bucket(const std::array<std::int32_t, 3>& cell) const noexcept
+	{
+		// the table size is a power of two
+		return cell_hash(cell) & static_cast<std::uint32_t>(_starts.size() - 2);
+	}
+
+	void PhotonMap::aim(const Scene& scene, const LightTree& lights, const fx::vec3& light) noexcept
+	{
+		_sources.clear();
+		_cdf.clear();
+
+		const auto spheres = scene.spheres();
+
+		fx::vec3 lo{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+		fx::vec3 hi{ std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+		std::vector<float> radii;
+		radii.reserve(spheres.size());
+
+		std::vector<std::uint32_t> targets;
+
+		for (auto i = 0u; i < spheres.size(); i++)
+		{
+			const auto& sphere = spheres[i];
+			const fx::vec3 center{ sphere.x, sphere.y, sphere.z };
+
+			for (auto axis = 0; axis < 3; axis++)
+			{
+				lo[axis] = std::min(lo[axis], center[axis] - sphere.radius);
+				hi[axis] = std::max(hi[axis], center[axis] + sphere.radius);
+			}
+
+			radii.push_back(sphere.radius);
+
+			if (scene.material(i).metallic > 0.f)
+			{
+				targets.push_back(i);
+			}
+		}
+
+		const auto add = [&](const CausticSource& source)
+		{
+			if (_sources.size() >= ::MAX_SOURCES || luminance(source.power) <= 0.f)
+			{
+				return;
+			}
+
+			_sources.push_back(source);
+			_cdf.push_back((_cdf.empty() ? 0.f : _cdf.back()) + luminance(source.power));
+		};
+
+		if (!lights.empty())
+		{
+			for (auto e = 0u; e < lights.size(); e++)
+			{
+				const auto& emitter = lights.emitter(e);
+
+				// a sphere's radiant intensity is its radiance over its projected disk
+				const auto intensity = fx::scale(emitter.emission, fx::pi() * emitter.radius * emitter.radius);
+
+				for (const auto t : targets)
+				{
+					const auto& sphere = spheres[t];
+					const fx::vec3 center{ sphere.x, sphere.y, sphere.z };
+
+					const auto to = fx::subtract(center, emitter.center);
+					const auto distance = std::sqrt(fx::dot(to, to));
+
+					if (t == emitter.primitive || distance <= sphere.radius + emitter.radius)
+					{
+						continue;
+					}
+
+					const auto solid_angle = 2.f * fx::pi() * cone_extent(sphere.radius, distance);
+					add({ emitter.center, emitter.radius, center, sphere.radius, fx::scale(intensity, solid_angle) });
+				}
+			}
+		}
+
+		else
+		{
+			// photons start from a disk facing the light, placed outside the scene so that anything in between still casts its shadow
+			const auto diameter = std::sqrt(fx::dot(fx::subtract(hi, lo), fx::subtract(hi, lo)));
+			const auto offset = fx::scale(fx::normalize(light), diameter);
+
+			for (const auto t : targets)
+			{
+				const auto& sphere = spheres[t];
+				const auto area = fx::pi() * sphere.radius * sphere.radius;
+
+				add({ offset, 0.f, { sphere.x, sphere.y, sphere.z }, sphere.radius, fx::broadcast<3>(DIRECTIONAL_IRRADIANCE * area) });
+			}
+		}
+
+		if (_sources.size() >= ::MAX_SOURCES)
+		{
+			warning(std::format("caustic photons are only aimed along the first {} light and metal pairs", ::MAX_SOURCES));
+		}
+
+		// the median ignores the odd huge sphere used as a floor or backdrop
+		if (!radii.empty())
+		{
+			const auto middle = radii.begin() + radii.size() / 2;
+			std::nth_element(radii.begin(), middle, radii.end());
+
+			_initial_radius = INITIAL_RADIUS * *middle;
+		}
+
+		restart();
+	}
+
+	void PhotonMap::restart(void) noexcept
+	{
+		_radius = _initial_radius;
+		_pass = 0;
+
+		_photons.clear();
+		_starts.assign(2, 0);
+		_keys.clear();
+	}
+
+	bool PhotonMap::emit(float u, const fx::vec2& uv, Ray& ray, fx::vec3& power) const noexcept
+	{
+		if (_cdf.empty())
+		{
+			return false;
+		}
+
+		const auto total = _cdf.back();
+		const auto found = std::upper_bound(_cdf.begin(), _cdf.end(), u * total);
+		const auto index = static_cast<std::size_t>(std::min(found - _cdf.begin(), static_cast<std::ptrdiff_t>(_cdf.size() - 1)));
+
+		const auto& source = _sources[index];
+		const auto pmf = luminance(source.power) / total;
+
+		power = fx::scale(source.power, 1.f / pmf);
+
+		fx::vec3 tangent{}, bitangent{};
+
+		if (source.light_radius == 0.f)
+		{
+			// uniform point on the target's silhouette as seen from the light
+			const auto dir = fx::invert(fx::normalize(source.light));
+			orthonormal_basis(dir, tangent, bitangent);
+
+			const auto r = source.target_radius * std::sqrt(uv[0]);
+			const auto phi = 2.f * fx::pi() * uv[1];
+
+			const auto point = fx::add(source.target, fx::add(fx::scale(tangent, r * std::cos(phi)), fx::scale(bitangent, r * std::sin(phi))));
+
+			ray = { fx::add(point, source.light), dir };
+			return true;
+		}
+
+		// uniform direction within the cone the target subtends from the emitter's center
+		const auto to = fx::subtract(source.target, source.light);
+		const auto distance = std::sqrt(fx::dot(to, to));
+		const auto w = fx::scale(to, 1.f / distance);
+
+		orthonormal_basis(w, tangent, bitangent);
+
+		const auto one_minus_cos = uv[0] * cone_extent(source.target_radius, distance);
+		const auto cos_theta = 1.f - one_minus_cos;
+		const auto sin_theta = std::sqrt(std::max(0.f, one_minus_cos * (2.f - one_minus_cos)));
+		const auto phi = 2.f * fx::pi() * uv[1];
+
+		const auto dir = fx::add(fx::add(fx::scale(tangent, sin_theta * std::cos(phi)), fx::scale(bitangent, sin_theta * std::sin(phi))), fx::scale(w, cos_theta));
+
+		// leave from the emitter's surface rather than its center, which lies inside it; the surface
+		// normal there is the direction itself
+		ray = { offset_origin(fx::add(source.light, fx::scale(dir, source.light_radius)), dir), dir };
+		return true;
+	}
+
+	void PhotonMap::build(std::span<const Photon> emitted) noexcept
+	{
+		std::vector<Photon> landed(emitted.size());
+
+		const auto end = std::copy_if(std::execution::par, emitted.begin(), emitted.end(), landed.begin(), [](const Photon& photon)
+		{
+			return photon.power[0] > 0.f || photon.power[1] > 0.f || photon.power[2] > 0.f;
+		});
+
+		landed.erase(end, landed.end());
+
+		const auto count = static_cast<std::uint32_t>(landed.size());
+		const auto table = std::bit_ceil(std::max(count, 1u));
+
+		_starts.assign(table + 1, 0);
+		_keys.resize(count);
+
+		std::transform(std::execution::par, landed.begin(), landed.end(), _keys.begin(), [&](const Photon& photon)
+		{
+			return bucket(cell(photon.pos));
+		});
+
+		// counting sort: bucket sizes, their prefix sum, then a scatter through per-bucket cursors
+		std::vector<std::atomic<std::uint32_t>> cursors(table);
+
+		std::for_each(std::execution::par, _keys.begin(), _keys.end(), [&](std::uint32_t key)
+		{
+			cursors[key].fetch_add(1, std::memory_order_relaxed);
+		});
+
+		auto offset = 0u;
+		for (auto i = 0u; i < table; i++)
+		{
+			_starts[i] = offset;
+			offset += cursors[i].load(std::memory_order_relaxed);
+			cursors[i].store(_starts[i], std::memory_order_relaxed);
+		}
+
+		_starts[table] = offset;
+		_photons.resize(count);
+
+		std::vector<std::uint32_t> indices(count);
+		std::iota(indices.begin(), indices.end(), 0u);
+
+		std::for_each(std::execution::par, indices.begin(), indices.end(), [&](std::uint32_t index)
+		{
+			_photons[cursors[_keys[index]].fetch_add(1, std::memory_order_relaxed)] = landed[index];
+		});
+	}
+
+	void PhotonMap::advance(void) noexcept
+	{
+		_pass++;
+
+		// r_(i+1)^2 = r_i^2 (i + alpha) / (i + 1), with passes counted from one
+		const auto i = static_cast<float>(_pass);
+		_radius *= std::sqrt((i + ALPHA) / (i + 1.f));
+	}
+
+	fx::vec3 PhotonMap::gather(const fx::vec3& pos, const fx::vec3& normal) const noexcept
+	{
+		fx::vec3 sum{};
+
+		if (_photons.empty())
+		{
+			return sum;
+		}
+
+		const auto base = cell(pos);
+		const auto size = 2.f * _radius;
+
+		// the neighbour along each axis is on whichever side of the cell the point lies closer to
+		std::array<std::int32_t, 3> step{};
+		for (auto axis = 0; axis < 3; axis++)
+		{
+			step[axis] = pos[axis] - base[axis] * size >= _radius ? 1 : -1;
+		}
+
+		const auto radius2 = _radius * _radius;
+
+		// distinct cells can share a bucket, which must then only be searched once
+		std::array<std::uint32_t, 8> visited{};
+		auto visited_count = 0u;
+
+		for (auto corner = 0u; corner < 8; corner++)
+		{
+			const std::array<std::int32_t, 3> neighbour
+			{
+				base[0] + ((corner & 1u) ? step[0] : 0),
+				base[1] + ((corner & 2u) ? step[1] : 0),
+				base[2] + ((corner & 4u) ? step[2] : 0),
+			};
+
+			const auto key = bucket(neighbour);
+
+			if (std::find(visited.begin(), visited.begin() + visited_count, key) != visited.begin() + visited_count)
+			{
+				continue;
+			}
+
+			visited[visited_count++] = key;
+
+			for (auto i = _starts[key]; i < _starts[key + 1]; i++)
+			{
+				const auto& photon = _photons[i];
+				const auto offset = fx::subtract(photon.pos, pos);
+
+				if (fx::dot(offset, offset) < radius2 && fx::dot(photon.normal, normal) > ::NORMAL_AGREEMENT)
+				{
+					sum = fx::add(sum, photon.power);
+				}
+			}
+		}
+
+		return fx::scale(sum, 1.f / (fx::pi() * radius2));
+	}
+}
@@ -0,0 +1,98 @@
+#ifndef LUMA_PHOTONS_H
+#define LUMA_PHOTONS_H
+
+#include "flux/types.h"
+#include "geometry.h"
+#include "scene.h"
+#include "lights.h"
+
+// photons.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	struct Photon
+	{
+		fx::vec3 pos;
+		// surface the photon landed on, so that gathers do not pick up photons from the other side of thin geometry
+		fx::vec3 normal;
+		// flux carried by the photon; zero marks an empty slot
+		fx::vec3 power;
+	};
+
+	// a light and one reflective sphere its photons are aimed at, since only photons that reflect
+	// off a metal before landing form caustics
+	struct CausticSource
+	{
+		// emitter center, or for the directional light the offset from the target back out of the scene
+		fx::vec3 light;
+		// zero for the directional light
+		float light_radius;
+		fx::vec3 target;
+		float target_radius;
+		// flux the light sends towards the target
+		fx::vec3 power;
+	};
+
+	// caustic photons of one progressive pass, sorted by hashed grid cell so that each cell's photons
+	// are contiguous in memory; the grid is rebuilt from scratch every pass
+	//
+	// the gather radius shrinks between passes as in probabilistic progressive photon mapping
+	// (knaus and zwicker 2011), so that the average of every pass's estimate converges to the
+	// true caustic while each pass stays independent of the others
+	class PhotonMap
+	{
+	public:
+		// share of the photon density kept from one pass to the next; lower values shrink faster
+		static constexpr auto ALPHA = 2.f / 3.f;
+		// starting radius relative to the median sphere radius
+		static constexpr auto INITIAL_RADIUS = .1f;
+		// irradiance of the directional light when the scene has no emitters
+		static constexpr auto DIRECTIONAL_IRRADIANCE = 1.f;
+
+	private:
+		std::vector<CausticSource> _sources;
+		// running sum of source luminance, for picking sources by their flux
+		std::vector<float> _cdf;
+
+		std::vector<Photon> _photons;
+		// first photon of each hash bucket, with one trailing entry holding the photon count
+		std::vector<std::uint32_t> _starts;
+		std::vector<std::uint32_t> _keys;
+
+		float _initial_radius = 1.f;
+		float _radius = 1.f;
+		std::uint32_t _pass = 0;
+
+	private:
+		std::array<std::int32_t, 3> cell(const fx::vec3&) const noexcept;
+		std::uint32_t bucket(const std::array<std::int32_t, 3>&) const noexcept;
+
+	public:
+		// pairs every emitter, or the directional light when there are none, with every metallic sphere
+		// and picks the starting radius; must be redone when the scene or its materials change
+		void aim(const Scene&, const LightTree&, const fx::vec3&) noexcept;
+		// restarts the radius schedule and drops every photon
+		void restart(void) noexcept;
+
+		// ray of one photon along with its share of the total flux before dividing by the photon count;
+		// false when nothing is lit
+		bool emit(float, const fx::vec2&, Ray&, fx::vec3&) const noexcept;
+
+		// sorts the pass's landed photons into the grid at the current radius; runs in parallel
+		void build(std::span<const Photon>) noexcept;
+		// shrinks the radius for the next pass
+		void advance(void) noexcept;
+
+		// flux per unit area arriving within the current radius of the point
+		fx::vec3 gather(const fx::vec3&, const fx::vec3&) const noexcept;
+
+	public:
+		bool empty(void) const noexcept { return _sources.empty(); }
+		float radius(void) const noexcept { return _radius; }
+		std::uint32_t pass(void) const noexcept { return _pass; }
+		std::size_t size(void) const noexcept { return _photons.size(); }
+	};
+}
+
+#endif
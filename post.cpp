@@ -0,0 +1,50 @@
+import std;
+
+#include "post.h"
+#include "kernels.h"
+
+// post.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	// pixels per parallel task: large enough to amortize scheduling, small enough to spread 1080p over
+	// every core
+	constexpr auto TILE = 1u << 14;
+}
+
+namespace luma
+{
+	const std::int32_t* srgb_table(void) noexcept
+	{
+		static const auto table = []
+		{
+			std::array<std::int32_t, SRGB_TABLE_SIZE> out{};
+
+			for (auto i = 0u; i < SRGB_TABLE_SIZE; i++)
+			{
+				const auto display = static_cast<float>(i) / (SRGB_TABLE_SIZE - 1);
+				out[i] = static_cast<std::int32_t>(255.f * encode_srgb(display) + .5f);
+			}
+
+			return out;
+		}();
+
+		return table.data();
+	}
+
+	void post_process(const fx::vec3* colors, std::uint32_t* target, std::uint32_t count, float exposure) noexcept
+	{
+		std::vector<std::uint32_t> tiles((count + ::TILE - 1) / ::TILE);
+		std::iota(tiles.begin(), tiles.end(), 0u);
+
+		const auto& kernel = kernels();
+		const auto table = srgb_table();
+
+		std::for_each(std::execution::par, tiles.begin(), tiles.end(), [&](std::uint32_t tile)
+		{
+			const auto begin = tile * ::TILE;
+			kernel.tonemap(colors + begin, target + begin, std::min(::TILE, count - begin), exposure, table);
+		});
+	}
+}
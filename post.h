@@ -0,0 +1,59 @@
+#ifndef LUMA_POST_H
+#define LUMA_POST_H
+
+#include "flux/types.h"
+#include "simd.h"
+
+// post.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// entries of the srgb encoding table, indexed by display values in [0, 1]; steps this fine stay
+	// under one 8-bit code apart even in the linear segment near black
+	static constexpr auto SRGB_TABLE_SIZE = 4096u;
+
+	// display curve of the accumulated radiance: 1 - e^-x per channel
+	inline fx::vec3 tonemap(const fx::vec3& color) noexcept
+	{
+		auto func = [&](float in)
+		{
+			return 1 - std::exp(-in);
+		};
+
+		return
+		{
+			func(color[0]),
+			func(color[1]),
+			func(color[2]),
+		};
+	}
+
+	// the same curve over eight channels, through the polynomial exponential; negative and nan
+	// inputs come out as black
+	inline simd::float8 tonemap(const simd::float8& in) noexcept
+	{
+		const auto zero = simd::broadcast(0.f);
+		return simd::subtract(simd::broadcast(1.f), simd::exp(simd::subtract(zero, simd::max(in, zero))));
+	}
+
+	// srgb transfer function of a linear display value
+	inline float encode_srgb(float linear) noexcept
+	{
+		if (linear <= .0031308f)
+		{
+			return 12.92f * linear;
+		}
+
+		return 1.055f * std::pow(linear, 1.f / 2.4f) - .055f;
+	}
+
+	// 8-bit srgb codes of SRGB_TABLE_SIZE evenly spaced display values
+	const std::int32_t* srgb_table(void) noexcept;
+
+	// exposure, display curve, srgb encoding and packing to 0x00RRGGBB for a whole frame, split into
+	// tiles that run in parallel through the selected kernel variant
+	void post_process(const fx::vec3*, std::uint32_t*, std::uint32_t, float) noexcept;
+}
+
+#endif
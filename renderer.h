@@ -3,51 +3,55 @@
 
 #include "flux/types.h"
 #include "camera.h"
+#include "geometry.h"
+#include "bvh.h"
+#include "grid.h"
+#include "scene.h"
+#include "sampler.h"
+#include "denoise.h"
+#include "gbuffer.h"
+#include "lights.h"
+#include "restir.h"
+#include "environment.h"
+#include "guiding.h"
+#include "irradiance.h"
+#include "photons.h"
+#include "shadows.h"
+#include "arguments.h"
 
 // renderer.h
 // (c) 2025 Connor J. Link. All Rights Reserved.
 
 namespace luma
 {
-	struct Ray
-	{
-		fx::vec3 pos, dir;
-	};
-
 	struct PixelResult
 	{
+		// linear radiance; tonemapping happens once the frame is resolved
 		fx::vec3 output;
 		fx::platform_type depth;
-	};
-
-	struct Material
-	{
-		fx::vec3 diffuse;
-		float albedo; // controls the amount of indirect light recieved
-		float metallic; // controls the strength of reflections
-		float roughness; // controls the dispersion of reflections
-	};
-
-	struct Sphere
-	{
-		fx::vec3 pos;
-		float radius;
-		Material material;
+		// first-hit features for the denoiser
+		fx::vec3 normal, albedo;
+		// sphere the first hit landed on
+		std::uint32_t primitive = Hit::NONE;
 	};
 
 
+	// shading data for the closest hit, resolved from a Hit
 	struct Intersection
 	{
 		fx::vec3 pos;
 		fx::vec3 normal;
-		float distance, exit;
-		Sphere* object;
-
-		auto operator<=>(const Intersection& rhs) const = default;
+		float distance;
+		const Material* material;
+		std::uint32_t primitive;
 	};
 
 	class Renderer
 	{
+	public:
+		static constexpr auto NO_PIXEL = std::numeric_limits<std::uint32_t>::max();
+		static constexpr auto NO_MATERIAL = std::numeric_limits<std::uint32_t>::max();
+
 	public:
 		float frametime = 0.f;
 		float frame_count = 1.f;
@@ -55,33 +59,131 @@ namespace luma
 		bool accumulate = true;
 		fx::vec3* accumulated_data = nullptr;
 
+		Features features;
+		Denoiser denoiser;
+		// mean of accumulated_data, filtered in place before post-processing; unused without a denoiser,
+		// where the post-process pass reads the accumulation directly
+		std::vector<fx::vec3> resolved;
+
+		// this frame's samples alone, which svgf filters against its own history instead of the accumulation
+		std::vector<fx::vec3> frame_color;
+		Features frame_features;
+		Svgf svgf;
+
+		GBuffer gbuffer;
+
+		// material table the current accumulation was shaded with, to detect edits to scene.materials
+		std::vector<Material> shaded_materials;
+
+		// accumulated samples whose first hit has the last edited material, over its diffuse colour, and
+		// how many there were; a diffuse-only edit of that material rescales the accumulation by them
+		// instead of restarting it, in scenes where nothing is shaded past the first hit
+		std::uint32_t reshaded_material = NO_MATERIAL;
+		std::vector<fx::vec3> reshading;
+		std::vector<float> reshading_hits;
+
 		Camera camera;
 
 		Intersection* closest = nullptr;
 
-		Sphere s{ {  0, .5f, -10 }, 1.0f, { { 0, 0, 1 }, 1, .001f, .4 } };
-		Sphere q{ {  3, .5f, -10 }, 1.0f, { { 0, 1, 0 }, 1, .001f, .4 } };
-		Sphere r{ {  6, .5f, -10 }, 1.0f, { { 1, 0, 0 }, 1, .001f, .4 } };
+		// built-in scene used when no scene file is given
+		std::vector<Material> materials
+		{
+			{ { 0, 0, 1 }, 1, .001f, .4 },
+			{ { 0, 1, 0 }, 1, .001f, .4 },
+			{ { 1, 0, 0 }, 1, .001f, .4 },
+			{ { 1, 1, 1 }, 1, .4f, 0 },
+			{ { .6, .6, .6 }, 1, .1, .5 },
+		};
+
+		Sphere s{ {  0, .5f, -10 }, 1.0f, 0 };
+		Sphere q{ {  3, .5f, -10 }, 1.0f, 1 };
+		Sphere r{ {  6, .5f, -10 }, 1.0f, 2 };
 
-		Sphere t{ {  3, .5f, -23 }, 10.0f, { { 1, 1, 1 }, 1, .4f, 0 } };
+		Sphere t{ {  3, .5f, -23 }, 10.0f, 3 };
 
-		Sphere a{ { 0, 102, 0 }, 100, { { .6, .6, .6 }, 1, .1, .5 } };
+		Sphere a{ { 0, 102, 0 }, 100, 4 };
 
 		std::vector<Sphere> spheres{ s, a, q, r, t };
 
+		Scene scene;
+
+		BVH bvh;
+		Grid grid;
+
+		// emissive spheres, sampled for direct lighting
+		LightTree light_tree;
+		// lights the scene from every direction rays escape into when loaded
+		Environment environment;
+		// learned distribution of indirect light when guiding is enabled
+		Guide guide;
+		// indirect light of primary hits, interpolated between sparse records when enabled
+		IrradianceCache irradiance_cache;
+		// caustics of the current photon pass, and the photons traced for it before they are sorted
+		PhotonMap photon_map;
+		std::vector<Photon> photons;
+		// light reaching each pixel from this frame's light paths, added to concurrently as float atomics
+		std::vector<fx::vec3> splats;
+		// visibility of the directional light, traced once for the light direction it was built with
+		ShadowMap shadow_map;
+		fx::vec3 shadowed_light{};
+		// per-pixel light reservoirs reused across frames and neighbours when lights are set to restir
+		Restir restir;
+
+		// resolved from _options.acceleration once the scene is known
+		Acceleration acceleration = Acceleration::BVH;
+
 		fx::vec3 light{ -1, -1, 0 };
 
 	public:
 		Renderer(void) noexcept;
 		void render_to(std::uint32_t*, olc::PixelGameEngine*) noexcept;
 
+		// material of the sphere seen through the centre of a pixel; empty over the sky or before the first frame
+		std::optional<std::uint16_t> material_at(std::uint32_t, std::uint32_t) const noexcept;
+		// replaces an entry of the material table; the next frame notices the edit and restarts the
+		// accumulation without touching the cached visibility
+		bool edit_material(std::uint16_t, const Material&) noexcept;
+
 	private:
-		Intersection miss(void) noexcept;
-		fx::vec3 direct_illumination(const Intersection&) noexcept;
-		fx::vec3 indirect_illumination(const Intersection&) noexcept;
-		Ray reflect_intersection(const Intersection&, const Ray&) noexcept;
+		// radiance arriving along a ray that left the scene
+		fx::vec3 miss(const fx::vec3&) const noexcept;
+		// the pixel index selects reservoir resampling for primary hits; other hits take a single light sample
+		fx::vec3 direct_illumination(const Intersection&, const Sampler&, std::uint32_t, std::uint32_t = NO_PIXEL) noexcept;
+		fx::vec3 emitter_illumination(const Intersection&, const Sampler&, std::uint32_t, std::uint32_t) noexcept;
+		fx::vec3 environment_illumination(const Intersection&, const Sampler&, std::uint32_t) noexcept;
+		// primary hits are served from the irradiance cache when it is enabled
+		fx::vec3 indirect_illumination(const Intersection&, const Sampler&, std::uint32_t, bool = false) noexcept;
+		// traces one pass of caustic photons in parallel and sorts them into the photon map
+		void trace_photons(void) noexcept;
+		// traces one light path per pixel in parallel and splats each camera connection into the pixel it lands in
+		void trace_light_paths(void) noexcept;
+		// the splatted light of a pixel, with the features of its primary hit for the denoisers
+		PixelResult splatted_pixel(std::uint32_t, std::uint32_t, const Hit&) noexcept;
+		// diffuse color shaded by short-range ambient occlusion and the directional light, for previews
+		PixelResult occlusion_pixel(std::uint32_t, std::uint32_t, const Hit&) noexcept;
+		void build_shadow_map(void) noexcept;
+		// whether the directional light reaches a hit, answered by the shadow map wherever it can
+		bool sees_light(const Intersection&) noexcept;
+		Ray reflect_intersection(const Intersection&, const Ray&, const Sampler&, std::uint32_t) noexcept;
+		Hit closest_hit(const Ray&, float = std::numeric_limits<float>::max()) noexcept;
+		bool any_hit(const Ray&, float = std::numeric_limits<float>::max()) noexcept;
+		// closest hit of a jittered primary ray, given the cached hit of the unjittered ray through its pixel
+		Hit primary_hit(const Ray&, const Hit&) noexcept;
+		Intersection resolve(const Ray&, const Hit&) noexcept;
 		Intersection trace_ray(const Ray&) noexcept;
-		PixelResult render_pixel(std::uint32_t, std::uint32_t, fx::platform_type = .001f) noexcept;
+		// a cached primary hit, when given, stands in for the traversal of the first jittered ray
+		PixelResult render_pixel(std::uint32_t, std::uint32_t, fx::platform_type = .001f, const Hit* = nullptr) noexcept;
+
+		float defocus(const Hit&) const noexcept;
+		// draws the post-processed frame with the defocus preview, one circle per pixel
+		void present(const std::uint32_t*, olc::PixelGameEngine*) noexcept;
+		void accumulate_sample(std::uint32_t, const PixelResult&, float) noexcept;
+		// starts collecting the per-pixel sums for a material, or stops with NO_MATERIAL
+		void track_material(std::uint32_t) noexcept;
+		// applies a diffuse-only edit of the tracked material to the accumulation; false when it cannot
+		bool reshade(std::uint32_t) noexcept;
+		void reset_accumulation(void) noexcept;
 	};
 }
 
@@ -0,0 +1,268 @@
+import std;
+
+#include "flux/vector.h"
+#include "restir.h"
+#include "color.h"
+
+// restir.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	// reservoirs are only shared between surfaces this close in relative depth and orientation
+	constexpr auto SIMILAR_DEPTH = .1f;
+	constexpr auto SIMILAR_NORMAL = .9f;
+
+	// resampling target; candidates are kept in proportion to how bright they would make the pixel
+	float target(const luma::ShadingPoint& point, const luma::LightPoint& light, const luma::LightTree& tree) noexcept
+	{
+		return luma::luminance(luma::Restir::unshadowed(point, light, tree));
+	}
+
+	bool similar(const luma::ShadingPoint& lhs, const luma::ShadingPoint& rhs) noexcept
+	{
+		return lhs.depth > 0.f
+			&& std::abs(lhs.depth - rhs.depth) <= SIMILAR_DEPTH * rhs.depth
+			&& fx::dot(lhs.normal, rhs.normal) >= SIMILAR_NORMAL;
+	}
+}
+
+namespace luma
+{
+	bool Reservoir::update(const LightPoint& candidate, float candidate_weight, float candidate_count, float u) noexcept
+	{
+		weight_sum += candidate_weight;
+		count += candidate_count;
+
+		if (candidate_weight > 0.f && u * weight_sum < candidate_weight)
+		{
+			sample = candidate;
+			return true;
+		}
+
+		return false;
+	}
+
+	void Restir::resize(std::uint32_t width, std::uint32_t height) noexcept
+	{
+		_width = width;
+		_height = height;
+
+		const auto size = static_cast<std::size_t>(width) * height;
+
+		_previous.resize(size);
+		_current.resize(size);
+		_previous_surface.resize(size);
+		_current_surface.resize(size);
+
+		reset();
+	}
+
+	void Restir::reset(void) noexcept
+	{
+		_history = false;
+
+		std::fill(_previous_surface.begin(), _previous_surface.end(), ShadingPoint{});
+		std::fill(_current_surface.begin(), _current_surface.end(), ShadingPoint{});
+	}
+
+	void Restir::swap(void) noexcept
+	{
+		_previous.swap(_current);
+		_previous_surface.swap(_current_surface);
+
+		// pixels not shaded next frame, such as sky, must not look like valid history afterwards
+		std::fill(_current_surface.begin(), _current_surface.end(), ShadingPoint{});
+
+		_history = true;
+	}
+
+	Reservoir Restir::resample(const ShadingPoint& point, const Camera& camera, const LightTree& tree, const Sampler& sampler) const noexcept
+	{
+		Reservoir reservoir{};
+		auto kept_target = 0.f;
+
+		// initial candidates straight from the light tree
+		for (auto i = 0u; i < CANDIDATES; i++)
+		{
+			const auto dimension = Sampler::RESERVOIR + 4 * i;
+
+			LightSample sample{};
+
+			if (!tree.sample(point.pos, point.normal, sampler.get1d(dimension), sampler.get2d(dimension + 1), sample))
+			{
+				reservoir.count += 1.f;
+				continue;
+			}
+
+			const auto cos_light = -fx::dot(sample.normal, sample.dir);
+
+			if (cos_light <= 0.f)
+			{
+				reservoir.count += 1.f;
+				continue;
+			}
+
+			const LightPoint candidate{ fx::add(point.pos, fx::scale(sample.dir, sample.distance)), sample.emitter };
+
+			// the target is measured per unit light area, so the solid angle density is converted to match
+			const auto pdf = sample.pdf * cos_light / (sample.distance * sample.distance);
+			const auto candidate_target = ::target(point, candidate, tree);
+
+			if (reservoir.update(candidate, candidate_target / pdf, 1.f, sampler.get1d(dimension + 3)))
+			{
+				kept_target = candidate_target;
+			}
+		}
+
+		reservoir.weight = 0.f;
+
+		if (kept_target > 0.f)
+		{
+			reservoir.weight = reservoir.weight_sum / (reservoir.count * kept_target);
+		}
+
+		if (!_history)
+		{
+			return reservoir;
+		}
+
+		// every reservoir that takes part in the reuse, the first being this pixel's own candidates
+		struct Domain
+		{
+			const ShadingPoint* surface;
+			const Reservoir* reservoir;
+			float count;
+		};
+
+		std::array<Domain, NEIGHBOURS + 1> domains{};
+		auto domain_count = 0u;
+
+		domains[domain_count++] = { &point, &reservoir, reservoir.count };
+
+		const auto previous = camera.reproject(point.pos);
+		const auto max_count = MAX_HISTORY * CANDIDATES;
+
+		for (auto i = 0u; i < NEIGHBOURS; i++)
+		{
+			const auto dimension = Sampler::RESERVOIR + 4 * (CANDIDATES + i);
+
+			auto px = previous[0];
+			auto py = previous[1];
+
+			// the first tap is the temporal one, the rest are spread uniformly over a disk around it
+			if (i > 0)
+			{
+				const auto uv = sampler.get2d(dimension);
+				const auto radius = RADIUS * std::sqrt(uv[0]);
+				const auto angle = 2.f * fx::pi() * uv[1];
+
+				px += radius * std::cos(angle);
+				py += radius * std::sin(angle);
+			}
+
+			const auto qx = static_cast<std::int32_t>(std::floor(px));
+			const auto qy = static_cast<std::int32_t>(std::floor(py));
+
+			if (qx < 0 || qy < 0 || qx >= static_cast<std::int32_t>(_width) || qy >= static_cast<std::int32_t>(_height))
+			{
+				continue;
+			}
+
+			const auto q = static_cast<std::size_t>(qy) * _width + qx;
+
+			if (::similar(_previous_surface[q], point))
+			{
+				domains[domain_count++] = { &_previous_surface[q], &_previous[q], std::min(_previous[q].count, max_count) };
+			}
+		}
+
+		Reservoir combined{};
+		kept_target = 0.f;
+
+		for (auto i = 0u; i < domain_count; i++)
+		{
+			const auto& domain = domains[i];
+			const auto& sample = domain.reservoir->sample;
+
+			auto weight = 0.f;
+			auto sample_target = 0.f;
+
+			if (domain.reservoir->weight > 0.f)
+			{
+				// generalised balance heuristic: the share of this sample that the domain it came from
+				// would have produced, which keeps samples that were unlikely at a neighbour from exploding
+				auto total = 0.f;
+				auto own = 0.f;
+
+				for (auto j = 0u; j < domain_count; j++)
+				{
+					const auto share = domains[j].count * ::target(*domains[j].surface, sample, tree);
+					total += share;
+
+					if (j == i)
+					{
+						own = share;
+					}
+				}
+
+				sample_target = ::target(point, sample, tree);
+
+				if (total > 0.f)
+				{
+					weight = own / total * sample_target * domain.reservoir->weight;
+				}
+			}
+
+			const auto u = sampler.get1d(Sampler::RESERVOIR + 4 * (CANDIDATES + NEIGHBOURS + i));
+
+			if (combined.update(sample, weight, domain.count, u))
+			{
+				kept_target = sample_target;
+			}
+		}
+
+		combined.weight = 0.f;
+
+		if (kept_target > 0.f)
+		{
+			combined.weight = combined.weight_sum / kept_target;
+		}
+
+		return combined;
+	}
+
+	void Restir::store(std::uint32_t pixel, const Reservoir& reservoir, const ShadingPoint& point) noexcept
+	{
+		_current[pixel] = reservoir;
+		_current_surface[pixel] = point;
+	}
+
+	fx::vec3 Restir::unshadowed(const ShadingPoint& point, const LightPoint& light, const LightTree& tree) noexcept
+	{
+		const auto& emitter = tree.emitter(light.emitter);
+
+		const auto to = fx::subtract(light.pos, point.pos);
+		const auto distance2 = fx::dot(to, to);
+
+		if (distance2 <= 0.f)
+		{
+			return fx::vec3();
+		}
+
+		const auto dir = fx::scale(to, 1.f / std::sqrt(distance2));
+		const auto light_normal = fx::normalize(fx::subtract(light.pos, emitter.center));
+
+		const auto cos_surface = fx::dot(point.normal, dir);
+		const auto cos_light = -fx::dot(light_normal, dir);
+
+		if (cos_surface <= 0.f || cos_light <= 0.f)
+		{
+			return fx::vec3();
+		}
+
+		// lambertian brdf, with the geometry term of an area light
+		const auto scalar = cos_surface * cos_light / (fx::pi() * distance2);
+		return fx::scale(fx::multiply(point.diffuse, emitter.emission), scalar);
+	}
+}
@@ -0,0 +1,88 @@
+#ifndef LUMA_RESTIR_H
+#define LUMA_RESTIR_H
+
+#include "flux/types.h"
+#include "camera.h"
+#include "lights.h"
+#include "sampler.h"
+
+// restir.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// point on the surface of one of the light tree's emitters
+	struct LightPoint
+	{
+		fx::vec3 pos;
+		std::uint32_t emitter;
+	};
+
+	// weighted reservoir holding one light point out of every candidate streamed through it
+	struct Reservoir
+	{
+		LightPoint sample;
+		// sum of the resampling weights seen so far
+		float weight_sum;
+		// number of candidates the reservoir stands for
+		float count;
+		// contribution weight of the kept sample, i.e. its reciprocal effective density
+		float weight;
+
+		// returns whether the candidate replaced the kept sample
+		bool update(const LightPoint&, float, float, float) noexcept;
+	};
+
+	// primary hit being lit, plus what neighbouring pixels compare against before sharing reservoirs
+	struct ShadingPoint
+	{
+		fx::vec3 pos, normal, diffuse;
+		float depth;
+	};
+
+	// reservoir-based spatiotemporal importance resampling (bitterli et al. 2020) for the first hit's
+	// direct lighting: every pixel streams CANDIDATES light tree samples through a reservoir weighted
+	// by their unshadowed contribution, then merges the previous frame's reservoirs at its
+	// reprojected position and a few pixels around it, so one shadow ray stands for hundreds of candidates
+	//
+	// spatial neighbours are read from the previous frame as well, which lets the renderer resample
+	// inside its single per-pixel pass; reused samples are weighted with the generalised balance
+	// heuristic over the unshadowed targets, and occluded samples are dropped from the reservoirs so
+	// they do not spread
+	class Restir
+	{
+	public:
+		static constexpr auto CANDIDATES = 32u;
+		// previous-frame reservoirs merged per pixel; the first is the reprojected pixel itself
+		static constexpr auto NEIGHBOURS = 5u;
+		// pixel radius the remaining neighbours are drawn from
+		static constexpr auto RADIUS = 16.f;
+		// caps how many candidates reused reservoirs may stand for, relative to one frame's candidates
+		static constexpr auto MAX_HISTORY = 4.f;
+
+	private:
+		std::uint32_t _width = 0, _height = 0;
+
+		std::vector<Reservoir> _previous, _current;
+		// normal and depth each reservoir was built for; zero depth marks pixels that had no surface
+		std::vector<ShadingPoint> _previous_surface, _current_surface;
+
+		bool _history = false;
+
+	public:
+		void resize(std::uint32_t, std::uint32_t) noexcept;
+		// forgets every reservoir, e.g. once the emitters they refer to have been rebuilt
+		void reset(void) noexcept;
+		// makes this frame's reservoirs the history of the next
+		void swap(void) noexcept;
+
+		Reservoir resample(const ShadingPoint&, const Camera&, const LightTree&, const Sampler&) const noexcept;
+		void store(std::uint32_t, const Reservoir&, const ShadingPoint&) noexcept;
+
+	public:
+		// light the point would reflect towards the camera from the given light point if nothing was in between
+		static fx::vec3 unshadowed(const ShadingPoint&, const LightPoint&, const LightTree&) noexcept;
+	};
+}
+
+#endif
@@ -0,0 +1,317 @@
+import std;
+
+#include "sampler.h"
+#include "flux/timer.h"
+#include "log.h"
+
+// sampler.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	std::uint32_t reverse_bits(std::uint32_t x) noexcept
+	{
+		x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+		x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+		x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+		x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+		return (x >> 16) | (x << 16);
+	}
+
+	std::uint32_t hash(std::uint32_t x) noexcept
+	{
+		// lowbias32
+		x ^= x >> 16;
+		x *= 0x7feb352du;
+		x ^= x >> 15;
+		x *= 0x846ca68bu;
+		x ^= x >> 16;
+		return x;
+	}
+
+	std::uint32_t hash_combine(std::uint32_t seed, std::uint32_t value) noexcept
+	{
+		return seed ^ (value + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+	}
+
+	// laine-karras style permutation; only ever propagates bits upward, so applied to a
+	// bit-reversed value it is equivalent to a nested uniform (owen) scramble
+	std::uint32_t laine_karras(std::uint32_t x, std::uint32_t seed) noexcept
+	{
+		x += seed;
+		x ^= x * 0x6c50b47cu;
+		x ^= x * 0xb82f1e52u;
+		x ^= x * 0xc7afe638u;
+		x ^= x * 0x8d22f6e6u;
+		return x;
+	}
+
+	std::uint32_t owen_scramble(std::uint32_t x, std::uint32_t seed) noexcept
+	{
+		return ::reverse_bits(::laine_karras(::reverse_bits(x), seed));
+	}
+
+	// the first two sobol dimensions: van der corput and the (x + 1) polynomial
+	std::uint32_t sobol0(std::uint32_t index) noexcept
+	{
+		return ::reverse_bits(index);
+	}
+
+	std::uint32_t sobol1(std::uint32_t index) noexcept
+	{
+		auto out = 0u;
+
+		for (auto v = 1u << 31; index != 0; index >>= 1, v ^= v >> 1)
+		{
+			if (index & 1)
+			{
+				out ^= v;
+			}
+		}
+
+		return out;
+	}
+
+	float to_float(std::uint32_t x) noexcept
+	{
+		// keep 24 bits so the result stays strictly below one
+		return static_cast<float>(x >> 8) * 0x1p-24f;
+	}
+
+	float wrap(float x) noexcept
+	{
+		return x >= 1.f ? x - 1.f : x;
+	}
+}
+
+namespace
+{
+	using luma::Sampler;
+
+	static constexpr auto TILE_AREA = Sampler::TILE_SIZE * Sampler::TILE_SIZE;
+	static constexpr auto TILE_MASK = Sampler::TILE_SIZE - 1;
+
+	// void-and-cluster (ulichney 1993) over a toroidal tile; every cell receives a unique rank
+	class BlueNoise
+	{
+	private:
+		static constexpr auto SIGMA = 1.5f;
+
+		std::vector<float> _kernel;
+		std::vector<float> _energy;
+		std::vector<std::uint8_t> _set;
+
+	public:
+		std::array<float, TILE_AREA> values{};
+
+	private:
+		// energy contributed by a point at the origin to the cell at offset i, wrapped around the tile
+		void build_kernel(void) noexcept
+		{
+			_kernel.resize(TILE_AREA);
+
+			for (auto y = 0u; y < Sampler::TILE_SIZE; y++)
+			{
+				for (auto x = 0u; x < Sampler::TILE_SIZE; x++)
+				{
+					const auto dx = static_cast<float>(std::min(x, Sampler::TILE_SIZE - x));
+					const auto dy = static_cast<float>(std::min(y, Sampler::TILE_SIZE - y));
+
+					_kernel[y * Sampler::TILE_SIZE + x] = std::exp(-(dx * dx + dy * dy) / (2 * SIGMA * SIGMA));
+				}
+			}
+		}
+
+		void toggle(std::uint32_t cell) noexcept
+		{
+			const auto sign = _set[cell] ? -1.f : 1.f;
+			_set[cell] ^= 1;
+
+			const auto cx = cell & TILE_MASK;
+			const auto cy = cell / Sampler::TILE_SIZE;
+
+			for (auto y = 0u; y < Sampler::TILE_SIZE; y++)
+			{
+				const auto row = ((y - cy) & TILE_MASK) * Sampler::TILE_SIZE;
+
+				for (auto x = 0u; x < Sampler::TILE_SIZE; x++)
+				{
+					_energy[y * Sampler::TILE_SIZE + x] += sign * _kernel[row + ((x - cx) & TILE_MASK)];
+				}
+			}
+		}
+
+		// densest point when looking at set cells, emptiest gap otherwise
+		std::uint32_t extreme(bool tightest_cluster) const noexcept
+		{
+			auto best = 0u;
+			auto best_energy = tightest_cluster ? -std::numeric_limits<float>::max() : std::numeric_limits<float>::max();
+
+			for (auto i = 0u; i < TILE_AREA; i++)
+			{
+				if (static_cast<bool>(_set[i]) != tightest_cluster)
+				{
+					continue;
+				}
+
+				if (tightest_cluster ? _energy[i] > best_energy : _energy[i] < best_energy)
+				{
+					best = i;
+					best_energy = _energy[i];
+				}
+			}
+
+			return best;
+		}
+
+	public:
+		BlueNoise(void) noexcept
+		{
+			build_kernel();
+
+			_energy.assign(TILE_AREA, 0.f);
+			_set.assign(TILE_AREA, 0);
+
+			// initial pattern: a tenth of the cells at hashed positions
+			auto initial = 0u;
+
+			for (auto i = 0u; initial < TILE_AREA / 10; i++)
+			{
+				const auto cell = ::hash(i) % TILE_AREA;
+
+				if (!_set[cell])
+				{
+					toggle(cell);
+					initial++;
+				}
+			}
+
+			// relax by moving the tightest cluster into the largest void until they coincide
+			for (auto iteration = 0u; iteration < TILE_AREA; iteration++)
+			{
+				const auto cluster = extreme(true);
+				toggle(cluster);
+
+				const auto gap = extreme(false);
+				toggle(gap);
+
+				if (gap == cluster)
+				{
+					break;
+				}
+			}
+
+			const auto pattern = _set;
+			const auto energy = _energy;
+
+			std::vector<std::uint32_t> rank(TILE_AREA);
+
+			// ranks below the initial pattern come from removing its tightest clusters
+			for (auto r = initial; r-- > 0;)
+			{
+				const auto cluster = extreme(true);
+				toggle(cluster);
+				rank[cluster] = r;
+			}
+
+			_set = pattern;
+			_energy = energy;
+
+			// with a symmetric kernel the tightest cluster of empty cells is the largest void of set
+			// cells, so the remaining ranks are all found by filling voids
+			for (auto r = initial; r < TILE_AREA; r++)
+			{
+				const auto gap = extreme(false);
+				toggle(gap);
+				rank[gap] = r;
+			}
+
+			for (auto i = 0u; i < TILE_AREA; i++)
+			{
+				values[i] = (static_cast<float>(rank[i]) + .5f) / TILE_AREA;
+			}
+		}
+	};
+
+	const BlueNoise& blue_noise(void) noexcept
+	{
+		static const BlueNoise tile{};
+		return tile;
+	}
+}
+
+namespace luma
+{
+	Sampler::Sampler(Sampling sampling, std::uint32_t x, std::uint32_t y, std::uint32_t index) noexcept
+		: _sampling{ sampling }, _x{ x }, _y{ y }, _index{ index }
+	{
+		// blue noise shares one sequence across the image; the tile decorrelates neighbouring pixels
+		_seed = sampling == Sampling::BLUE_NOISE ? 0u : ::hash(::hash_combine(::hash(x), y));
+	}
+
+	Sampler Sampler::split(std::uint32_t path, std::uint32_t paths) const noexcept
+	{
+		auto out = *this;
+		out._index = _index * paths + path;
+		return out;
+	}
+
+	float Sampler::get1d(std::uint32_t dimension) const noexcept
+	{
+		return get2d(dimension)[0];
+	}
+
+	fx::vec2 Sampler::get2d(std::uint32_t dimension) const noexcept
+	{
+		const auto seed = ::hash(::hash_combine(_seed, dimension));
+
+		if (_sampling == Sampling::RANDOM)
+		{
+			const auto a = ::hash(::hash_combine(seed, _index));
+			const auto b = ::hash(a);
+
+			return { ::to_float(a), ::to_float(b) };
+		}
+
+		// shuffle the point order, then scramble each coordinate independently
+		const auto index = ::owen_scramble(_index, seed);
+
+		const auto u = ::to_float(::owen_scramble(::sobol0(index), ::hash_combine(seed, 0)));
+		const auto v = ::to_float(::owen_scramble(::sobol1(index), ::hash_combine(seed, 1)));
+
+		if (_sampling == Sampling::SOBOL)
+		{
+			return { u, v };
+		}
+
+		// each dimension reads the tile at its own offset so the shifts are uncorrelated
+		const auto offset = ::hash(seed ^ 0x5bd1e995u);
+		const auto& tile = ::blue_noise().values;
+
+		const auto ux = (_x + (offset & 0xffff)) & TILE_MASK;
+		const auto uy = (_y + (offset >> 16)) & TILE_MASK;
+		const auto vx = (ux + TILE_SIZE / 2) & TILE_MASK;
+		const auto vy = (uy + TILE_SIZE / 2 + 7) & TILE_MASK;
+
+		return
+		{
+			::wrap(u + tile[uy * TILE_SIZE + ux]),
+			::wrap(v + tile[vy * TILE_SIZE + vx]),
+		};
+	}
+
+	fx::vec3 Sampler::get3d(std::uint32_t dimension) const noexcept
+	{
+		const auto uv = get2d(dimension);
+		return { uv[0], uv[1], get1d(dimension + 2) };
+	}
+
+	void Sampler::prepare(void) noexcept
+	{
+		fx::Timer timer{};
+		const auto& tile = ::blue_noise();
+		(void)tile;
+
+		log(std::format("generated {}x{} blue-noise tile in {}ms", TILE_SIZE, TILE_SIZE, timer.milliseconds()));
+	}
+}
@@ -0,0 +1,63 @@
+#ifndef LUMA_SAMPLER_H
+#define LUMA_SAMPLER_H
+
+#include "flux/types.h"
+#include "arguments.h"
+
+// sampler.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// largest float below one, so that a rescaled sample never reaches the end of its interval
+	static constexpr auto ONE_MINUS_EPSILON = 0x1.fffffep-1f;
+
+	// deterministic sample values for one pixel sample, addressed by dimension rather than drawn in sequence
+	// so that every random decision of a path always reads the same dimension of the sequence
+	//
+	//   RANDOM      hashed white noise, kept as a reference
+	//   SOBOL       owen-scrambled, shuffled 2d sobol points, decorrelated per pixel and per dimension
+	//   BLUE_NOISE  one scrambled sobol sequence shared by all pixels, toroidally shifted per pixel
+	//               by a precomputed blue-noise tile so the remaining error is spread as blue noise
+	class Sampler
+	{
+	public:
+		// offsets of each decision within a bounce's block of dimensions
+		static constexpr auto LENS = 0u; // 3d jitter of the camera ray
+		static constexpr auto ROUGHNESS = 3u; // 3d perturbation of the reflection normal
+		static constexpr auto HEMISPHERE = 6u; // 2d direction of each indirect path
+		static constexpr auto LIGHT_PICK = 8u; // 1d choice of the light to sample
+		static constexpr auto LIGHT_POINT = 9u; // 2d point on the chosen light
+		static constexpr auto ENVIRONMENT = 11u; // 2d direction towards the environment
+		static constexpr auto GUIDE = 13u; // 1d choice between guided and cosine sampling of each indirect path
+		static constexpr auto DIMENSIONS_PER_BOUNCE = 16u;
+		// candidates and reuse decisions of reservoir resampling, placed past every bounce's block
+		static constexpr auto RESERVOIR = 1u << 16;
+
+		static constexpr auto TILE_SIZE = 64u;
+
+	private:
+		Sampling _sampling;
+		std::uint32_t _x, _y;
+		std::uint32_t _seed;
+		std::uint32_t _index;
+
+	public:
+		Sampler(Sampling, std::uint32_t x, std::uint32_t y, std::uint32_t index) noexcept;
+
+	public:
+		// sub-stream for one of several paths spawned from the same sample; keeps the paths stratified
+		Sampler split(std::uint32_t path, std::uint32_t paths) const noexcept;
+
+		float get1d(std::uint32_t) const noexcept;
+		fx::vec2 get2d(std::uint32_t) const noexcept;
+		// the 2d pair at the given dimension plus one value from dimension + 2
+		fx::vec3 get3d(std::uint32_t) const noexcept;
+
+	public:
+		// generates the blue-noise tile up front rather than on first use
+		static void prepare(void) noexcept;
+	};
+}
+
+#endif
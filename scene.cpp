@@ -0,0 +1,286 @@
+import std;
+
+#include "scene.h"
+#include "log.h"
+
+// scene.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	bool same(const luma::Material& lhs, const luma::Material& rhs) noexcept
+	{
+		return lhs.diffuse[0] == rhs.diffuse[0]
+			&& lhs.diffuse[1] == rhs.diffuse[1]
+			&& lhs.diffuse[2] == rhs.diffuse[2]
+			&& lhs.albedo == rhs.albedo
+			&& lhs.metallic == rhs.metallic
+			&& lhs.roughness == rhs.roughness
+			&& lhs.emission[0] == rhs.emission[0]
+			&& lhs.emission[1] == rhs.emission[1]
+			&& lhs.emission[2] == rhs.emission[2];
+	}
+
+	std::uint64_t align(std::uint64_t offset) noexcept
+	{
+		const auto alignment = luma::Scene::PARTICLE_ALIGNMENT;
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	// validates that [offset, offset + count * stride) lies inside the file and is suitably aligned
+	bool section(std::uint64_t offset, std::uint64_t count, std::uint64_t stride, std::uint64_t size) noexcept
+	{
+		if (offset % luma::Scene::PARTICLE_ALIGNMENT != 0 || offset > size)
+		{
+			return false;
+		}
+
+		return count <= (size - offset) / stride;
+	}
+}
+
+namespace luma
+{
+	void Scene::refresh(void) noexcept
+	{
+		_spheres = _sphere_storage;
+		_material_ids = _material_id_storage;
+	}
+
+	std::uint16_t Scene::add_material(const Material& material) noexcept
+	{
+		for (auto i = 0u; i < materials.size(); i++)
+		{
+			if (::same(materials[i], material))
+			{
+				return static_cast<std::uint16_t>(i);
+			}
+		}
+
+		if (materials.size() > std::numeric_limits<std::uint16_t>::max())
+		{
+			warning("material table is full; reusing the last material");
+			return std::numeric_limits<std::uint16_t>::max();
+		}
+
+		materials.push_back(material);
+		return static_cast<std::uint16_t>(materials.size() - 1);
+	}
+
+	void Scene::add_sphere(const fx::vec3& pos, float radius, std::uint16_t material) noexcept
+	{
+		_sphere_storage.push_back({ pos[0], pos[1], pos[2], radius });
+		_material_id_storage.push_back(material);
+
+		refresh();
+	}
+
+	void Scene::add(const Sphere& sphere) noexcept
+	{
+		add_sphere(sphere.pos, sphere.radius, sphere.material);
+	}
+
+	void Scene::assign(std::span<const Material> new_materials, std::span<const PackedSphere> spheres, std::span<const std::uint16_t> material_ids) noexcept
+	{
+		clear();
+
+		materials.assign(new_materials.begin(), new_materials.end());
+		_sphere_storage.assign(spheres.begin(), spheres.end());
+		_material_id_storage.assign(material_ids.begin(), material_ids.end());
+
+		refresh();
+	}
+
+	void Scene::clear(void) noexcept
+	{
+		_sphere_storage.clear();
+		_material_id_storage.clear();
+		_file.close();
+		_nodes = {};
+		materials.clear();
+
+		refresh();
+	}
+
+	void Scene::reorder(const std::vector<std::uint32_t>& order) noexcept
+	{
+		std::vector<PackedSphere> spheres(order.size());
+		std::vector<std::uint16_t> material_ids(order.size());
+
+		// reads through the views, so a mapped scene without a tree is copied into owned storage here
+		for (auto i = 0u; i < order.size(); i++)
+		{
+			spheres[i] = _spheres[order[i]];
+			material_ids[i] = _material_ids[order[i]];
+		}
+
+		_sphere_storage = std::move(spheres);
+		_material_id_storage = std::move(material_ids);
+
+		_file.close();
+		_nodes = {};
+
+		refresh();
+	}
+
+	bool Scene::open_particles(const std::string& filepath, bool validate) noexcept
+	{
+		clear();
+
+		if (!_file.open(filepath))
+		{
+			log(std::format("error opening particle file `{}`", filepath));
+			return false;
+		}
+
+		const auto size = static_cast<std::uint64_t>(_file.size());
+		const auto data = _file.data();
+
+		const auto fail = [&](const char* reason)
+		{
+			log(std::format("invalid particle file `{}`: {}", filepath, reason));
+			clear();
+			return false;
+		};
+
+		if (size < sizeof(ParticleHeader))
+		{
+			return fail("truncated header");
+		}
+
+		ParticleHeader header{};
+		std::memcpy(&header, data, sizeof(header));
+
+		if (std::memcmp(header.magic, PARTICLE_MAGIC, sizeof(PARTICLE_MAGIC)) != 0)
+		{
+			return fail("bad magic");
+		}
+
+		if (header.version != PARTICLE_VERSION)
+		{
+			return fail("unsupported version");
+		}
+
+		if (!::section(header.materials_offset, header.material_count, sizeof(PackedMaterial), size)
+		 || !::section(header.spheres_offset, header.sphere_count, sizeof(PackedSphere), size)
+		 || !::section(header.material_ids_offset, header.sphere_count, sizeof(std::uint16_t), size)
+		 || !::section(header.nodes_offset, header.node_count, sizeof(WideNode), size))
+		{
+			return fail("section out of bounds");
+		}
+
+		if (header.sphere_count > std::numeric_limits<std::uint32_t>::max() || header.node_count > std::numeric_limits<std::uint32_t>::max() || header.material_count == 0)
+		{
+			return fail("unsupported sphere, node or material count");
+		}
+
+		// the material table is tiny, so it is the only section copied out of the mapping
+		const auto packed = reinterpret_cast<const PackedMaterial*>(data + header.materials_offset);
+		materials.reserve(header.material_count);
+
+		for (auto i = 0u; i < header.material_count; i++)
+		{
+			const auto& material = packed[i];
+			materials.push_back({ { material.diffuse[0], material.diffuse[1], material.diffuse[2] },
+				material.albedo, material.metallic, material.roughness,
+				{ material.emission[0], material.emission[1], material.emission[2] } });
+		}
+
+		const auto count = static_cast<std::size_t>(header.sphere_count);
+
+		_spheres = { reinterpret_cast<const PackedSphere*>(data + header.spheres_offset), count };
+		_material_ids = { reinterpret_cast<const std::uint16_t*>(data + header.material_ids_offset), count };
+		_nodes = { reinterpret_cast<const WideNode*>(data + header.nodes_offset), static_cast<std::size_t>(header.node_count) };
+
+		// only the header is checked by default, so that opening a file touches none of its pages; material
+		// ids are clamped when they are read, and the tree is trusted unless a full validation is asked for
+		if (validate)
+		{
+			for (const auto id : _material_ids)
+			{
+				if (id >= header.material_count)
+				{
+					return fail("material index out of range");
+				}
+			}
+
+			if (!BVH::valid(_nodes, count))
+			{
+				return fail("malformed bvh");
+			}
+		}
+
+		return true;
+	}
+
+	bool Scene::save_particles(const std::string& filepath, std::span<const WideNode> nodes) const noexcept
+	{
+		std::ofstream file(filepath, std::ios::out | std::ios::binary);
+
+		if (!file)
+		{
+			log(std::format("error writing to file `{}`", filepath));
+			return false;
+		}
+
+		ParticleHeader header{};
+		std::memcpy(header.magic, PARTICLE_MAGIC, sizeof(PARTICLE_MAGIC));
+
+		header.version = PARTICLE_VERSION;
+		header.material_count = static_cast<std::uint32_t>(materials.size());
+		header.sphere_count = _spheres.size();
+		header.node_count = nodes.size();
+
+		header.materials_offset = ::align(sizeof(ParticleHeader));
+		header.spheres_offset = ::align(header.materials_offset + materials.size() * sizeof(PackedMaterial));
+		header.material_ids_offset = ::align(header.spheres_offset + _spheres.size_bytes());
+		header.nodes_offset = ::align(header.material_ids_offset + _material_ids.size_bytes());
+
+		auto written = std::uint64_t{ 0 };
+
+		const auto write = [&](const void* bytes, std::uint64_t size)
+		{
+			file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+			written += size;
+		};
+
+		const auto pad = [&](std::uint64_t offset)
+		{
+			static constexpr std::array<char, PARTICLE_ALIGNMENT> zeroes{};
+			write(zeroes.data(), offset - written);
+		};
+
+		write(&header, sizeof(header));
+
+		pad(header.materials_offset);
+
+		for (const auto& material : materials)
+		{
+			const PackedMaterial packed
+			{
+				{ material.diffuse[0], material.diffuse[1], material.diffuse[2] },
+				material.albedo, material.metallic, material.roughness,
+				{ material.emission[0], material.emission[1], material.emission[2] },
+			};
+
+			write(&packed, sizeof(packed));
+		}
+
+		pad(header.spheres_offset);
+		write(_spheres.data(), _spheres.size_bytes());
+
+		pad(header.material_ids_offset);
+		write(_material_ids.data(), _material_ids.size_bytes());
+
+		pad(header.nodes_offset);
+		write(nodes.data(), nodes.size_bytes());
+
+		if (!file.good())
+		{
+			log(std::format("error writing to file `{}`", filepath));
+			return false;
+		}
+
+		return true;
+	}
+}
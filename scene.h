@@ -0,0 +1,109 @@
+#ifndef LUMA_SCENE_H
+#define LUMA_SCENE_H
+
+#include "geometry.h"
+#include "bvh.h"
+#include "mapping.h"
+
+// scene.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	// particle files are used in place after being mapped, so every section is stored exactly as the
+	// renderer reads it: little-endian, each section starting on a 64-byte boundary
+	//
+	//   ParticleHeader
+	//   PackedMaterial[material_count]
+	//   PackedSphere[sphere_count]     (float x, y, z, radius in bvh traversal order)
+	//   std::uint16_t[sphere_count]    (material index of each sphere)
+	//   WideNode[node_count]           (prebuilt 8-wide bvh over the spheres)
+	struct ParticleHeader
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t material_count;
+		std::uint64_t sphere_count;
+		std::uint64_t node_count;
+		std::uint64_t materials_offset;
+		std::uint64_t spheres_offset;
+		std::uint64_t material_ids_offset;
+		std::uint64_t nodes_offset;
+	};
+
+	struct PackedMaterial
+	{
+		float diffuse[3];
+		float albedo, metallic, roughness;
+		float emission[3];
+	};
+
+	class Scene
+	{
+	public:
+		static constexpr char PARTICLE_MAGIC[8]{ 'L', 'U', 'M', 'A', 'P', 'R', 'T', '\0' };
+		static constexpr std::uint32_t PARTICLE_VERSION = 2;
+		static constexpr std::size_t PARTICLE_ALIGNMENT = 64;
+
+	private:
+		// owned geometry for scenes assembled in memory
+		std::vector<PackedSphere> _sphere_storage;
+		std::vector<std::uint16_t> _material_id_storage;
+
+		// backing storage for scenes opened from a particle file
+		MappedFile _file;
+
+		std::span<const PackedSphere> _spheres;
+		std::span<const std::uint16_t> _material_ids;
+		std::span<const WideNode> _nodes;
+
+	public:
+		std::vector<Material> materials;
+
+	private:
+		void refresh(void) noexcept;
+
+	public:
+		std::uint16_t add_material(const Material&) noexcept;
+		void add_sphere(const fx::vec3&, float, std::uint16_t) noexcept;
+		void add(const Sphere&) noexcept;
+		void assign(std::span<const Material>, std::span<const PackedSphere>, std::span<const std::uint16_t>) noexcept;
+		void clear(void) noexcept;
+
+		// rearranges owned geometry into the given order, e.g. bvh traversal order
+		void reorder(const std::vector<std::uint32_t>&) noexcept;
+
+	public:
+		// validation reads every material id and walks the whole tree, paging in most of the file
+		bool open_particles(const std::string&, bool = false) noexcept;
+		bool save_particles(const std::string&, std::span<const WideNode>) const noexcept;
+
+	public:
+		std::span<const PackedSphere> spheres(void) const noexcept { return _spheres; }
+		std::span<const std::uint16_t> material_ids(void) const noexcept { return _material_ids; }
+		// non-empty when the scene was opened with a bvh already built
+		std::span<const WideNode> prebuilt(void) const noexcept { return _nodes; }
+
+		std::size_t size(void) const noexcept { return _spheres.size(); }
+		bool empty(void) const noexcept { return _spheres.empty(); }
+
+		// mapped files are not scanned for ids past the material table, so those are clamped to its last entry
+		std::uint16_t material_id(std::uint32_t primitive) const noexcept
+		{
+			return static_cast<std::uint16_t>(std::min<std::size_t>(_material_ids[primitive], materials.size() - 1));
+		}
+
+		const Material& material(std::uint32_t primitive) const noexcept
+		{
+			return materials[material_id(primitive)];
+		}
+
+		fx::vec3 center(std::uint32_t primitive) const noexcept
+		{
+			const auto& sphere = _spheres[primitive];
+			return { sphere.x, sphere.y, sphere.z };
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,147 @@
+import std;
+
+#include "flux/vector.h"
+#include "shadows.h"
+
+// shadows.cpp
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace
+{
+	constexpr auto MISS = std::numeric_limits<float>::infinity();
+}
+
+namespace luma
+{
+	void ShadowMap::prepare(const Scene& scene, const fx::vec3& light) noexcept
+	{
+		_dir = fx::normalize(light);
+
+		// the map's texels are laid out across the light direction
+		orthonormal_basis(_dir, _tangent, _bitangent);
+
+		const auto spheres = scene.spheres();
+
+		std::vector<float> radii;
+		radii.reserve(spheres.size());
+
+		for (const auto& sphere : spheres)
+		{
+			radii.push_back(sphere.radius);
+		}
+
+		auto backdrop = std::numeric_limits<float>::max();
+
+		if (!radii.empty())
+		{
+			const auto middle = radii.begin() + radii.size() / 2;
+			std::nth_element(radii.begin(), middle, radii.end());
+
+			backdrop = BACKDROP_RADIUS * *middle;
+		}
+
+		auto u_min = std::numeric_limits<float>::max(), u_max = std::numeric_limits<float>::lowest();
+		auto v_min = u_min, v_max = u_max;
+		auto top = u_max;
+
+		for (const auto& sphere : spheres)
+		{
+			const fx::vec3 center{ sphere.x, sphere.y, sphere.z };
+
+			// every sphere has to lie below the map's plane, but only the others decide its footprint
+			top = std::max(top, fx::dot(center, _dir) + sphere.radius);
+
+			if (sphere.radius > backdrop)
+			{
+				continue;
+			}
+
+			const auto u = fx::dot(center, _tangent);
+			const auto v = fx::dot(center, _bitangent);
+
+			u_min = std::min(u_min, u - sphere.radius);
+			u_max = std::max(u_max, u + sphere.radius);
+			v_min = std::min(v_min, v - sphere.radius);
+			v_max = std::max(v_max, v + sphere.radius);
+		}
+
+		if (u_min > u_max)
+		{
+			_depth.clear();
+			return;
+		}
+
+		// square texels over the larger side keep the lookup isotropic
+		_texel = std::max(std::max(u_max - u_min, v_max - v_min) / RESOLUTION, 1e-6f);
+		_u0 = u_min;
+		_v0 = v_min;
+		_top = top + _texel;
+
+		_depth.assign(static_cast<std::size_t>(RESOLUTION) * RESOLUTION, ::MISS);
+	}
+
+	Ray ShadowMap::texel_ray(std::uint32_t x, std::uint32_t y) const noexcept
+	{
+		const auto u = _u0 + (x + .5f) * _texel;
+		const auto v = _v0 + (y + .5f) * _texel;
+
+		const auto pos = fx::add(fx::add(fx::scale(_tangent, u), fx::scale(_bitangent, v)), fx::scale(_dir, _top));
+		return { pos, fx::invert(_dir) };
+	}
+
+	void ShadowMap::store(std::uint32_t x, std::uint32_t y, float depth) noexcept
+	{
+		_depth[y * RESOLUTION + x] = depth;
+	}
+
+	Visibility ShadowMap::lookup(const fx::vec3& pos) const noexcept
+	{
+		if (_depth.empty())
+		{
+			return Visibility::UNKNOWN;
+		}
+
+		// texel centers sit at half-integer coordinates
+		const auto column = (fx::dot(pos, _tangent) - _u0) / _texel - .5f;
+		const auto line = (fx::dot(pos, _bitangent) - _v0) / _texel - .5f;
+
+		const auto x = static_cast<std::int32_t>(std::floor(column));
+		const auto y = static_cast<std::int32_t>(std::floor(line));
+
+		if (x < 0 || y < 0 || x + 1 >= static_cast<std::int32_t>(RESOLUTION) || y + 1 >= static_cast<std::int32_t>(RESOLUTION))
+		{
+			return Visibility::UNKNOWN;
+		}
+
+		const auto row = static_cast<std::size_t>(y) * RESOLUTION + x;
+
+		const std::array<float, 4> depths{ _depth[row], _depth[row + 1], _depth[row + RESOLUTION], _depth[row + RESOLUTION + 1] };
+
+		const auto [near, far] = std::minmax_element(depths.begin(), depths.end());
+
+		// light passes by on all four sides, which at this resolution leaves no room for an occluder
+		if (*near == ::MISS)
+		{
+			return Visibility::LIT;
+		}
+
+		if (*far == ::MISS || *far - *near > EDGE_SLOPE * _texel)
+		{
+			return Visibility::UNKNOWN;
+		}
+
+		const auto tx = column - x;
+		const auto ty = line - y;
+
+		const auto upper = depths[0] + (depths[1] - depths[0]) * tx;
+		const auto lower = depths[2] + (depths[3] - depths[2]) * tx;
+		const auto surface = upper + (lower - upper) * ty;
+
+		// a point on the lit surface itself lands within the spread of its texels; one texel more
+		// covers the curvature the bilinear fit misses
+		const auto depth = _top - fx::dot(pos, _dir);
+		const auto bias = (*far - *near) + _texel;
+
+		return depth <= surface + bias ? Visibility::LIT : Visibility::SHADOWED;
+	}
+}
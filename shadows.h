@@ -0,0 +1,65 @@
+#ifndef LUMA_SHADOWS_H
+#define LUMA_SHADOWS_H
+
+#include "flux/types.h"
+#include "geometry.h"
+#include "scene.h"
+
+// shadows.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma
+{
+	enum class Visibility
+	{
+		LIT,
+		SHADOWED,
+		// too close to a silhouette for the map to tell; a shadow ray has to decide
+		UNKNOWN,
+	};
+
+	// ray-traced shadow map for the directional light: one ray per texel of a grid facing the light
+	// records how deep into the scene light first reaches, so that most shadow queries become a lookup
+	//
+	// a query is only answered when the four texels around it saw one smooth surface; around
+	// silhouettes and outside the map it returns UNKNOWN rather than guessing
+	class ShadowMap
+	{
+	public:
+		static constexpr auto RESOLUTION = 2048u;
+		// neighbouring depths further apart than this many texel widths straddle a silhouette
+		static constexpr auto EDGE_SLOPE = 8.f;
+		// spheres this many times the median radius are floors and backdrops, which would spread the
+		// map's texels over far more ground than any shadow falls on; points outside the map fall back
+		static constexpr auto BACKDROP_RADIUS = 10.f;
+
+	private:
+		// unit direction towards the light and the two axes of the map across it
+		fx::vec3 _dir, _tangent, _bitangent;
+		// corner of the map in (tangent, bitangent) coordinates
+		float _u0 = 0.f, _v0 = 0.f;
+		float _texel = 1.f;
+		// distance of the map's plane along _dir, from which depths are measured
+		float _top = 0.f;
+
+		// first-hit depth of each texel's ray, infinite where light passes through the scene
+		std::vector<float> _depth;
+
+	public:
+		// fits the map around the scene as seen from the light; every texel must then be stored, unless
+		// the map is left empty for a scene with nothing in it
+		void prepare(const Scene&, const fx::vec3&) noexcept;
+
+		// ray through the center of a texel, starting outside the scene and heading away from the light
+		Ray texel_ray(std::uint32_t, std::uint32_t) const noexcept;
+		void store(std::uint32_t, std::uint32_t, float) noexcept;
+
+		Visibility lookup(const fx::vec3&) const noexcept;
+
+	public:
+		bool empty(void) const noexcept { return _depth.empty(); }
+		const fx::vec3& direction(void) const noexcept { return _dir; }
+	};
+}
+
+#endif
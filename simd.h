@@ -0,0 +1,584 @@
+#ifndef LUMA_SIMD_H
+#define LUMA_SIMD_H
+
+// avx-512 builds run the avx2 backend, which the compiler then encodes with the wider instruction set
+#if defined(__AVX2__)
+#define LUMA_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LUMA_SIMD_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define LUMA_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// everything below lives in a namespace named after the instruction set it is compiled for, so that
+// the kernel variants in kernels_*.cpp never share a definition the linker could pick from the wrong one
+#if defined(__AVX512F__)
+#define LUMA_SIMD_ISA avx512
+#elif defined(LUMA_SIMD_AVX2)
+#define LUMA_SIMD_ISA avx2
+#elif defined(LUMA_SIMD_SSE)
+#define LUMA_SIMD_ISA sse2
+#elif defined(LUMA_SIMD_NEON)
+#define LUMA_SIMD_ISA neon
+#else
+#define LUMA_SIMD_ISA scalar
+#endif
+
+#include "flux/types.h"
+
+// simd.h
+// (c) 2025 Connor J. Link. All Rights Reserved.
+
+namespace luma::simd::inline LUMA_SIMD_ISA
+{
+	// eight lanes of floats: one ymm register with avx2, a pair of 128-bit registers with sse or neon,
+	// and a plain array everywhere else so that the kernels built on top still compile and run
+	struct float8
+	{
+#if defined(LUMA_SIMD_AVX2)
+		__m256 v;
+#elif defined(LUMA_SIMD_SSE)
+		__m128 lo, hi;
+#elif defined(LUMA_SIMD_NEON)
+		float32x4_t lo, hi;
+#else
+		std::array<float, 8> v;
+#endif
+	};
+
+	// comparison results carry all-ones or all-zeros bits per lane
+	using mask8 = float8;
+
+	// structure-of-arrays: lane i of x, y and z together make up the i-th vector
+	struct vec3x8
+	{
+		float8 x, y, z;
+	};
+
+	// eight lanes of 32-bit integers, for table lookups and the values they return
+	struct index8
+	{
+#if defined(LUMA_SIMD_AVX2)
+		__m256i v;
+#elif defined(LUMA_SIMD_SSE)
+		__m128i lo, hi;
+#elif defined(LUMA_SIMD_NEON)
+		int32x4_t lo, hi;
+#else
+		std::array<std::int32_t, 8> v;
+#endif
+	};
+
+	static constexpr auto WIDTH = 8u;
+
+	constexpr const char* backend(void) noexcept
+	{
+#if defined(__AVX512F__)
+		return "avx512";
+#elif defined(LUMA_SIMD_AVX2)
+		return "avx2";
+#elif defined(LUMA_SIMD_SSE)
+		return "sse2";
+#elif defined(LUMA_SIMD_NEON)
+		return "neon";
+#else
+		return "scalar";
+#endif
+	}
+
+#if defined(LUMA_SIMD_AVX2)
+	inline float8 broadcast(float s) noexcept { return { _mm256_set1_ps(s) }; }
+	inline float8 load(const float* in) noexcept { return { _mm256_loadu_ps(in) }; }
+	inline void store(float* out, const float8& a) noexcept { _mm256_storeu_ps(out, a.v); }
+
+	// eight unsigned bytes widened to floats
+	inline float8 load(const std::uint8_t* in) noexcept
+	{
+		return { _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)))) };
+	}
+
+	inline float8 add(const float8& a, const float8& b) noexcept { return { _mm256_add_ps(a.v, b.v) }; }
+	inline float8 subtract(const float8& a, const float8& b) noexcept { return { _mm256_sub_ps(a.v, b.v) }; }
+	inline float8 multiply(const float8& a, const float8& b) noexcept { return { _mm256_mul_ps(a.v, b.v) }; }
+	inline float8 divide(const float8& a, const float8& b) noexcept { return { _mm256_div_ps(a.v, b.v) }; }
+	inline float8 fmadd(const float8& a, const float8& b, const float8& c) noexcept { return { _mm256_fmadd_ps(a.v, b.v, c.v) }; }
+	inline float8 min(const float8& a, const float8& b) noexcept { return { _mm256_min_ps(a.v, b.v) }; }
+	inline float8 max(const float8& a, const float8& b) noexcept { return { _mm256_max_ps(a.v, b.v) }; }
+	inline float8 sqrt(const float8& a) noexcept { return { _mm256_sqrt_ps(a.v) }; }
+	inline float8 floor(const float8& a) noexcept { return { _mm256_floor_ps(a.v) }; }
+
+	inline mask8 less(const float8& a, const float8& b) noexcept { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+	inline mask8 less_equal(const float8& a, const float8& b) noexcept { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+	inline mask8 greater(const float8& a, const float8& b) noexcept { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+	inline mask8 both(const mask8& a, const mask8& b) noexcept { return { _mm256_and_ps(a.v, b.v) }; }
+	// lanes of a where the mask is set, of b elsewhere
+	inline float8 select(const mask8& mask, const float8& a, const float8& b) noexcept { return { _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+	inline std::uint32_t bits(const mask8& mask) noexcept { return static_cast<std::uint32_t>(_mm256_movemask_ps(mask.v)); }
+
+	// 2^n for whole n within the normal range
+	inline float8 exp2i(const float8& n) noexcept
+	{
+		return { _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(n.v), _mm256_set1_epi32(127)), 23)) };
+	}
+
+	// hardware estimates are good to 12 bits; one newton step brings them to about 22
+	inline float8 rsqrt(const float8& a) noexcept
+	{
+		const auto y = _mm256_rsqrt_ps(a.v);
+		const auto half = _mm256_mul_ps(_mm256_set1_ps(.5f), a.v);
+		return { _mm256_mul_ps(y, _mm256_fnmadd_ps(half, _mm256_mul_ps(y, y), _mm256_set1_ps(1.5f))) };
+	}
+
+	inline float8 rcp(const float8& a) noexcept
+	{
+		const auto y = _mm256_rcp_ps(a.v);
+		return { _mm256_mul_ps(y, _mm256_fnmadd_ps(a.v, y, _mm256_set1_ps(2.f))) };
+	}
+
+	inline index8 truncate(const float8& a) noexcept { return { _mm256_cvttps_epi32(a.v) }; }
+	inline index8 gather(const std::int32_t* table, const index8& index) noexcept { return { _mm256_i32gather_epi32(table, index.v, 4) }; }
+
+	// 24 consecutive channels in 0-255, three to a pixel in r, g, b order, written as eight 0x00RRGGBB pixels
+	inline void pack_rgb(std::uint32_t* out, const index8& a, const index8& b, const index8& c) noexcept
+	{
+		// narrowing works within 128-bit halves, which leaves four-channel groups in the order
+		// 0-3, 8-11, 16-19, -, 4-7, 12-15, 20-23, -
+		const auto words = _mm256_packus_epi32(a.v, b.v);
+		const auto tail = _mm256_packus_epi32(c.v, c.v);
+		const auto bytes = _mm256_packus_epi16(words, tail);
+
+		// channels 0-11 into the low half and 12-23 into the high one, where each half then holds four pixels
+		const auto halves = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 1, 5, 2, 6, 6));
+
+		const auto pixels = _mm256_setr_epi8(
+			2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+			2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_shuffle_epi8(halves, pixels));
+	}
+#elif defined(LUMA_SIMD_SSE)
+	inline float8 broadcast(float s) noexcept { const auto v = _mm_set1_ps(s); return { v, v }; }
+	inline float8 load(const float* in) noexcept { return { _mm_loadu_ps(in), _mm_loadu_ps(in + 4) }; }
+	inline void store(float* out, const float8& a) noexcept { _mm_storeu_ps(out, a.lo); _mm_storeu_ps(out + 4, a.hi); }
+
+	inline float8 load(const std::uint8_t* in) noexcept
+	{
+		const auto zero = _mm_setzero_si128();
+		const auto words = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)), zero);
+
+		return { _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), _mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero)) };
+	}
+
+	inline float8 add(const float8& a, const float8& b) noexcept { return { _mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi) }; }
+	inline float8 subtract(const float8& a, const float8& b) noexcept { return { _mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi) }; }
+	inline float8 multiply(const float8& a, const float8& b) noexcept { return { _mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi) }; }
+	inline float8 divide(const float8& a, const float8& b) noexcept { return { _mm_div_ps(a.lo, b.lo), _mm_div_ps(a.hi, b.hi) }; }
+	// sse2 has no fused multiply-add
+	inline float8 fmadd(const float8& a, const float8& b, const float8& c) noexcept { return add(multiply(a, b), c); }
+	inline float8 min(const float8& a, const float8& b) noexcept { return { _mm_min_ps(a.lo, b.lo), _mm_min_ps(a.hi, b.hi) }; }
+	inline float8 max(const float8& a, const float8& b) noexcept { return { _mm_max_ps(a.lo, b.lo), _mm_max_ps(a.hi, b.hi) }; }
+	inline float8 sqrt(const float8& a) noexcept { return { _mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi) }; }
+
+	inline mask8 less(const float8& a, const float8& b) noexcept { return { _mm_cmplt_ps(a.lo, b.lo), _mm_cmplt_ps(a.hi, b.hi) }; }
+	inline mask8 less_equal(const float8& a, const float8& b) noexcept { return { _mm_cmple_ps(a.lo, b.lo), _mm_cmple_ps(a.hi, b.hi) }; }
+	inline mask8 greater(const float8& a, const float8& b) noexcept { return { _mm_cmpgt_ps(a.lo, b.lo), _mm_cmpgt_ps(a.hi, b.hi) }; }
+	inline mask8 both(const mask8& a, const mask8& b) noexcept { return { _mm_and_ps(a.lo, b.lo), _mm_and_ps(a.hi, b.hi) }; }
+
+	inline float8 select(const mask8& mask, const float8& a, const float8& b) noexcept
+	{
+		return
+		{
+			_mm_or_ps(_mm_and_ps(mask.lo, a.lo), _mm_andnot_ps(mask.lo, b.lo)),
+			_mm_or_ps(_mm_and_ps(mask.hi, a.hi), _mm_andnot_ps(mask.hi, b.hi)),
+		};
+	}
+
+	inline std::uint32_t bits(const mask8& mask) noexcept
+	{
+		return static_cast<std::uint32_t>(_mm_movemask_ps(mask.lo) | (_mm_movemask_ps(mask.hi) << 4));
+	}
+
+	// sse2 has no rounding instruction: truncate, then step down wherever that rounded up
+	inline float8 floor(const float8& a) noexcept
+	{
+		const auto half = [](__m128 x)
+		{
+			const auto truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+			return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.f)));
+		};
+
+		return { half(a.lo), half(a.hi) };
+	}
+
+	inline float8 exp2i(const float8& n) noexcept
+	{
+		const auto half = [](__m128 x)
+		{
+			return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(x), _mm_set1_epi32(127)), 23));
+		};
+
+		return { half(n.lo), half(n.hi) };
+	}
+
+	inline float8 rsqrt(const float8& a) noexcept
+	{
+		const auto half = [](__m128 x)
+		{
+			const auto y = _mm_rsqrt_ps(x);
+			const auto yy = _mm_mul_ps(y, y);
+			return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(.5f), x), yy)));
+		};
+
+		return { half(a.lo), half(a.hi) };
+	}
+
+	inline float8 rcp(const float8& a) noexcept
+	{
+		const auto half = [](__m128 x)
+		{
+			const auto y = _mm_rcp_ps(x);
+			return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(2.f), _mm_mul_ps(x, y)));
+		};
+
+		return { half(a.lo), half(a.hi) };
+	}
+
+	inline index8 truncate(const float8& a) noexcept { return { _mm_cvttps_epi32(a.lo), _mm_cvttps_epi32(a.hi) }; }
+
+	inline index8 gather(const std::int32_t* table, const index8& index) noexcept
+	{
+		alignas(16) std::int32_t lanes[WIDTH];
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes), index.lo);
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes + 4), index.hi);
+
+		for (auto& lane : lanes)
+		{
+			lane = table[lane];
+		}
+
+		return { _mm_load_si128(reinterpret_cast<const __m128i*>(lanes)), _mm_load_si128(reinterpret_cast<const __m128i*>(lanes + 4)) };
+	}
+
+	// sse2 has no byte shuffle, so the channels are interleaved one pixel at a time
+	inline void pack_rgb(std::uint32_t* out, const index8& a, const index8& b, const index8& c) noexcept
+	{
+		alignas(16) std::int32_t channels[3 * WIDTH];
+		_mm_store_si128(reinterpret_cast<__m128i*>(channels), a.lo);
+		_mm_store_si128(reinterpret_cast<__m128i*>(channels + 4), a.hi);
+		_mm_store_si128(reinterpret_cast<__m128i*>(channels + 8), b.lo);
+		_mm_store_si128(reinterpret_cast<__m128i*>(channels + 12), b.hi);
+		_mm_store_si128(reinterpret_cast<__m128i*>(channels + 16), c.lo);
+		_mm_store_si128(reinterpret_cast<__m128i*>(channels + 20), c.hi);
+
+		for (auto i = 0u; i < WIDTH; i++)
+		{
+			out[i] = static_cast<std::uint32_t>((channels[3 * i] << 16) | (channels[3 * i + 1] << 8) | channels[3 * i + 2]);
+		}
+	}
+#elif defined(LUMA_SIMD_NEON)
+	inline float8 broadcast(float s) noexcept { const auto v = vdupq_n_f32(s); return { v, v }; }
+	inline float8 load(const float* in) noexcept { return { vld1q_f32(in), vld1q_f32(in + 4) }; }
+	inline void store(float* out, const float8& a) noexcept { vst1q_f32(out, a.lo); vst1q_f32(out + 4, a.hi); }
+
+	inline float8 load(const std::uint8_t* in) noexcept
+	{
+		const auto words = vmovl_u8(vld1_u8(in));
+		return { vcvtq_f32_u32(vmovl_u16(vget_low_u16(words))), vcvtq_f32_u32(vmovl_u16(vget_high_u16(words))) };
+	}
+
+	inline float8 add(const float8& a, const float8& b) noexcept { return { vaddq_f32(a.lo, b.lo), vaddq_f32(a.hi, b.hi) }; }
+	inline float8 subtract(const float8& a, const float8& b) noexcept { return { vsubq_f32(a.lo, b.lo), vsubq_f32(a.hi, b.hi) }; }
+	inline float8 multiply(const float8& a, const float8& b) noexcept { return { vmulq_f32(a.lo, b.lo), vmulq_f32(a.hi, b.hi) }; }
+	inline float8 divide(const float8& a, const float8& b) noexcept { return { vdivq_f32(a.lo, b.lo), vdivq_f32(a.hi, b.hi) }; }
+	inline float8 fmadd(const float8& a, const float8& b, const float8& c) noexcept { return { vfmaq_f32(c.lo, a.lo, b.lo), vfmaq_f32(c.hi, a.hi, b.hi) }; }
+	inline float8 min(const float8& a, const float8& b) noexcept { return { vminq_f32(a.lo, b.lo), vminq_f32(a.hi, b.hi) }; }
+	inline float8 max(const float8& a, const float8& b) noexcept { return { vmaxq_f32(a.lo, b.lo), vmaxq_f32(a.hi, b.hi) }; }
+	inline float8 sqrt(const float8& a) noexcept { return { vsqrtq_f32(a.lo), vsqrtq_f32(a.hi) }; }
+	inline float8 floor(const float8& a) noexcept { return { vrndmq_f32(a.lo), vrndmq_f32(a.hi) }; }
+
+	inline mask8 less(const float8& a, const float8& b) noexcept
+	{
+		return { vreinterpretq_f32_u32(vcltq_f32(a.lo, b.lo)), vreinterpretq_f32_u32(vcltq_f32(a.hi, b.hi)) };
+	}
+
+	inline mask8 greater(const float8& a, const float8& b) noexcept
+	{
+		return { vreinterpretq_f32_u32(vcgtq_f32(a.lo, b.lo)), vreinterpretq_f32_u32(vcgtq_f32(a.hi, b.hi)) };
+	}
+
+	inline mask8 less_equal(const float8& a, const float8& b) noexcept
+	{
+		return { vreinterpretq_f32_u32(vcleq_f32(a.lo, b.lo)), vreinterpretq_f32_u32(vcleq_f32(a.hi, b.hi)) };
+	}
+
+	inline mask8 both(const mask8& a, const mask8& b) noexcept
+	{
+		return
+		{
+			vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.lo), vreinterpretq_u32_f32(b.lo))),
+			vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.hi), vreinterpretq_u32_f32(b.hi))),
+		};
+	}
+
+	inline float8 select(const mask8& mask, const float8& a, const float8& b) noexcept
+	{
+		return { vbslq_f32(vreinterpretq_u32_f32(mask.lo), a.lo, b.lo), vbslq_f32(vreinterpretq_u32_f32(mask.hi), a.hi, b.hi) };
+	}
+
+	inline std::uint32_t bits(const mask8& mask) noexcept
+	{
+		// isolate each lane's sign bit, move it up to the lane's position, and sum across the register
+		static constexpr std::int32_t shifts[4]{ 0, 1, 2, 3 };
+		const auto shift = vld1q_s32(shifts);
+
+		const auto half = [&](float32x4_t x)
+		{
+			return vaddvq_u32(vshlq_u32(vshrq_n_u32(vreinterpretq_u32_f32(x), 31), shift));
+		};
+
+		return half(mask.lo) | (half(mask.hi) << 4);
+	}
+
+	inline float8 exp2i(const float8& n) noexcept
+	{
+		const auto half = [](float32x4_t x)
+		{
+			return vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(x), vdupq_n_s32(127)), 23));
+		};
+
+		return { half(n.lo), half(n.hi) };
+	}
+
+	// neon estimates are only good to 8 bits, so they take two newton steps
+	inline float8 rsqrt(const float8& a) noexcept
+	{
+		const auto half = [](float32x4_t x)
+		{
+			auto y = vrsqrteq_f32(x);
+			y = vmulq_f32(y, vrsqrtsq_f32(vmulq_f32(x, y), y));
+			y = vmulq_f32(y, vrsqrtsq_f32(vmulq_f32(x, y), y));
+			return y;
+		};
+
+		return { half(a.lo), half(a.hi) };
+	}
+
+	inline float8 rcp(const float8& a) noexcept
+	{
+		const auto half = [](float32x4_t x)
+		{
+			auto y = vrecpeq_f32(x);
+			y = vmulq_f32(y, vrecpsq_f32(x, y));
+			y = vmulq_f32(y, vrecpsq_f32(x, y));
+			return y;
+		};
+
+		return { half(a.lo), half(a.hi) };
+	}
+	inline index8 truncate(const float8& a) noexcept { return { vcvtq_s32_f32(a.lo), vcvtq_s32_f32(a.hi) }; }
+
+	inline index8 gather(const std::int32_t* table, const index8& index) noexcept
+	{
+		std::int32_t lanes[WIDTH];
+		vst1q_s32(lanes, index.lo);
+		vst1q_s32(lanes + 4, index.hi);
+
+		for (auto& lane : lanes)
+		{
+			lane = table[lane];
+		}
+
+		return { vld1q_s32(lanes), vld1q_s32(lanes + 4) };
+	}
+
+	inline void pack_rgb(std::uint32_t* out, const index8& a, const index8& b, const index8& c) noexcept
+	{
+		const auto narrow = [](const index8& x)
+		{
+			return vmovn_u16(vcombine_u16(vqmovun_s32(x.lo), vqmovun_s32(x.hi)));
+		};
+
+		// table lookups past the 24 channels come back as zero, which fills the top byte of each pixel
+		const uint8x16x2_t channels{ { vcombine_u8(narrow(a), narrow(b)), vcombine_u8(narrow(c), vdup_n_u8(0)) } };
+
+		static constexpr std::uint8_t first[16]{ 2, 1, 0, 255, 5, 4, 3, 255, 8, 7, 6, 255, 11, 10, 9, 255 };
+		static constexpr std::uint8_t second[16]{ 14, 13, 12, 255, 17, 16, 15, 255, 20, 19, 18, 255, 23, 22, 21, 255 };
+
+		vst1q_u8(reinterpret_cast<std::uint8_t*>(out), vqtbl2q_u8(channels, vld1q_u8(first)));
+		vst1q_u8(reinterpret_cast<std::uint8_t*>(out + 4), vqtbl2q_u8(channels, vld1q_u8(second)));
+	}
+#else
+	namespace detail
+	{
+		template<typename F>
+		float8 lanes(F&& f) noexcept
+		{
+			float8 out{};
+
+			for (auto i = 0u; i < WIDTH; i++)
+			{
+				out.v[i] = f(i);
+			}
+
+			return out;
+		}
+
+		inline float flag(bool set) noexcept
+		{
+			return std::bit_cast<float>(set ? 0xFFFFFFFFu : 0u);
+		}
+
+		inline bool is_set(float lane) noexcept
+		{
+			return (std::bit_cast<std::uint32_t>(lane) >> 31) != 0;
+		}
+	}
+
+	inline float8 broadcast(float s) noexcept { return detail::lanes([&](auto) { return s; }); }
+	inline float8 load(const float* in) noexcept { return detail::lanes([&](auto i) { return in[i]; }); }
+	inline void store(float* out, const float8& a) noexcept { std::copy(a.v.begin(), a.v.end(), out); }
+	inline float8 load(const std::uint8_t* in) noexcept { return detail::lanes([&](auto i) { return static_cast<float>(in[i]); }); }
+
+	inline float8 add(const float8& a, const float8& b) noexcept { return detail::lanes([&](auto i) { return a.v[i] + b.v[i]; }); }
+	inline float8 subtract(const float8& a, const float8& b) noexcept { return detail::lanes([&](auto i) { return a.v[i] - b.v[i]; }); }
+	inline float8 multiply(const float8& a, const float8& b) noexcept { return detail::lanes([&](auto i) { return a.v[i] * b.v[i]; }); }
+	inline float8 divide(const float8& a, const float8& b) noexcept { return detail::lanes([&](auto i) { return a.v[i] / b.v[i]; }); }
+	inline float8 fmadd(const float8& a, const float8& b, const float8& c) noexcept { return detail::lanes([&](auto i) { return std::fma(a.v[i], b.v[i], c.v[i]); }); }
+	inline float8 min(const float8& a, const float8& b) noexcept { return detail::lanes([&](auto i) { return std::min(a.v[i], b.v[i]); }); }
+	inline float8 max(const float8& a, const float8& b) noexcept { return detail::lanes([&](auto i) { return std::max(a.v[i], b.v[i]); }); }
+	inline float8 sqrt(const float8& a) noexcept { return detail::lanes([&](auto i) { return std::sqrt(a.v[i]); }); }
+	inline float8 floor(const float8& a) noexcept { return detail::lanes([&](auto i) { return std::floor(a.v[i]); }); }
+
+	inline mask8 less(const float8& a, const float8& b) noexcept { return detail::lanes([&](auto i) { return detail::flag(a.v[i] < b.v[i]); }); }
+	inline mask8 greater(const float8& a, const float8& b) noexcept { return detail::lanes([&](auto i) { return detail::flag(a.v[i] > b.v[i]); }); }
+	inline mask8 less_equal(const float8& a, const float8& b) noexcept { return detail::lanes([&](auto i) { return detail::flag(a.v[i] <= b.v[i]); }); }
+	inline mask8 both(const mask8& a, const mask8& b) noexcept { return detail::lanes([&](auto i) { return detail::flag(detail::is_set(a.v[i]) && detail::is_set(b.v[i])); }); }
+	inline float8 select(const mask8& mask, const float8& a, const float8& b) noexcept { return detail::lanes([&](auto i) { return detail::is_set(mask.v[i]) ? a.v[i] : b.v[i]; }); }
+
+	inline std::uint32_t bits(const mask8& mask) noexcept
+	{
+		auto out = 0u;
+
+		for (auto i = 0u; i < WIDTH; i++)
+		{
+			out |= (detail::is_set(mask.v[i]) ? 1u : 0u) << i;
+		}
+
+		return out;
+	}
+
+	inline float8 exp2i(const float8& n) noexcept { return detail::lanes([&](auto i) { return std::bit_cast<float>(static_cast<std::uint32_t>(static_cast<std::int32_t>(n.v[i]) + 127) << 23); }); }
+	inline float8 rsqrt(const float8& a) noexcept { return detail::lanes([&](auto i) { return 1.f / std::sqrt(a.v[i]); }); }
+	inline float8 rcp(const float8& a) noexcept { return detail::lanes([&](auto i) { return 1.f / a.v[i]; }); }
+	inline float8 exp(const float8& x) noexcept { return detail::lanes([&](auto i) { return std::exp(x.v[i]); }); }
+
+	inline index8 truncate(const float8& a) noexcept
+	{
+		index8 out{};
+
+		for (auto i = 0u; i < WIDTH; i++)
+		{
+			out.v[i] = static_cast<std::int32_t>(a.v[i]);
+		}
+
+		return out;
+	}
+
+	inline index8 gather(const std::int32_t* table, const index8& index) noexcept
+	{
+		index8 out{};
+
+		for (auto i = 0u; i < WIDTH; i++)
+		{
+			out.v[i] = table[index.v[i]];
+		}
+
+		return out;
+	}
+
+	inline void pack_rgb(std::uint32_t* out, const index8& a, const index8& b, const index8& c) noexcept
+	{
+		std::int32_t channels[3 * WIDTH];
+		std::copy(a.v.begin(), a.v.end(), channels);
+		std::copy(b.v.begin(), b.v.end(), channels + WIDTH);
+		std::copy(c.v.begin(), c.v.end(), channels + 2 * WIDTH);
+
+		for (auto i = 0u; i < WIDTH; i++)
+		{
+			out[i] = static_cast<std::uint32_t>((channels[3 * i] << 16) | (channels[3 * i + 1] << 8) | channels[3 * i + 2]);
+		}
+	}
+#endif
+
+#if defined(LUMA_SIMD_AVX2) || defined(LUMA_SIMD_SSE) || defined(LUMA_SIMD_NEON)
+
+	// e^x to about 2e-6 relative error: 2^(x log2 e) split into the nearest whole exponent and a taylor
+	// polynomial on the remaining fraction in [-1/2, 1/2]; inputs are clamped to where the result stays
+	// a normal float
+	inline float8 exp(const float8& x) noexcept
+	{
+		const auto t = min(max(multiply(x, broadcast(1.44269504f)), broadcast(-126.f)), broadcast(126.f));
+		const auto whole = floor(add(t, broadcast(.5f)));
+		const auto f = subtract(t, whole);
+
+		auto p = broadcast(1.33336e-3f);
+		p = fmadd(p, f, broadcast(9.61813e-3f));
+		p = fmadd(p, f, broadcast(5.55041e-2f));
+		p = fmadd(p, f, broadcast(2.40227e-1f));
+		p = fmadd(p, f, broadcast(6.93147e-1f));
+		p = fmadd(p, f, broadcast(1.f));
+
+		return multiply(p, exp2i(whole));
+	}
+#endif
+
+	inline vec3x8 broadcast(const fx::vec3& v) noexcept { return { broadcast(v[0]), broadcast(v[1]), broadcast(v[2]) }; }
+
+	// transposes up to eight consecutive vectors into lanes; missing lanes are zero
+	inline vec3x8 load(const fx::vec3* in, std::uint32_t count = WIDTH) noexcept
+	{
+		alignas(32) float x[WIDTH]{}, y[WIDTH]{}, z[WIDTH]{};
+
+		for (auto i = 0u; i < count; i++)
+		{
+			x[i] = in[i][0];
+			y[i] = in[i][1];
+			z[i] = in[i][2];
+		}
+
+		return { load(x), load(y), load(z) };
+	}
+
+	inline void store(fx::vec3* out, const vec3x8& a, std::uint32_t count = WIDTH) noexcept
+	{
+		alignas(32) float x[WIDTH], y[WIDTH], z[WIDTH];
+
+		store(x, a.x);
+		store(y, a.y);
+		store(z, a.z);
+
+		for (auto i = 0u; i < count; i++)
+		{
+			out[i] = { x[i], y[i], z[i] };
+		}
+	}
+
+	inline vec3x8 add(const vec3x8& a, const vec3x8& b) noexcept { return { add(a.x, b.x), add(a.y, b.y), add(a.z, b.z) }; }
+	inline vec3x8 subtract(const vec3x8& a, const vec3x8& b) noexcept { return { subtract(a.x, b.x), subtract(a.y, b.y), subtract(a.z, b.z) }; }
+	inline vec3x8 scale(const vec3x8& a, const float8& s) noexcept { return { multiply(a.x, s), multiply(a.y, s), multiply(a.z, s) }; }
+
+	inline float8 dot(const vec3x8& a, const vec3x8& b) noexcept
+	{
+		return fmadd(a.z, b.z, fmadd(a.y, b.y, multiply(a.x, b.x)));
+	}
+
+	inline vec3x8 normalize(const vec3x8& a) noexcept
+	{
+		return scale(a, rsqrt(dot(a, a)));
+	}
+}
+
+#endif